@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Collects benchmark results and prints them as CSV, or as JSON when the
+// program is run with --json.  Nothing is printed until the end so that
+// forked children never inherit buffered output
+class bench_report {
+	struct row_t {
+		std::string benchmark;
+		std::string parameter;
+		std::string metric;
+		double value;
+		std::string unit;
+	};
+
+	std::vector<row_t> m_rows{};
+	bool m_is_json = false;
+
+	void print_csv( ) const {
+		std::cout << "benchmark,parameter,metric,value,unit\n";
+		for( auto const &row : m_rows ) {
+			std::cout << row.benchmark << ',' << row.parameter << ',' << row.metric
+			          << ',' << row.value << ',' << row.unit << '\n';
+		}
+	}
+
+	void print_json( ) const {
+		std::cout << "[\n";
+		for( size_t n = 0; n < m_rows.size( ); ++n ) {
+			auto const &row = m_rows[n];
+			std::cout << "  {\"benchmark\": \"" << row.benchmark
+			          << "\", \"parameter\": \"" << row.parameter
+			          << "\", \"metric\": \"" << row.metric
+			          << "\", \"value\": " << row.value << ", \"unit\": \""
+			          << row.unit << "\"}" << ( n + 1 < m_rows.size( ) ? "," : "" )
+			          << '\n';
+		}
+		std::cout << "]\n";
+	}
+
+public:
+	bench_report( int argc, char **argv ) {
+		for( int n = 1; n < argc; ++n ) {
+			m_is_json |= std::string_view( argv[n] ) == "--json";
+		}
+	}
+
+	bench_report( bench_report const & ) = delete;
+	bench_report &operator=( bench_report const & ) = delete;
+
+	~bench_report( ) {
+		if( m_is_json ) {
+			print_json( );
+		} else {
+			print_csv( );
+		}
+		std::cout.flush( );
+	}
+
+	void add( std::string benchmark, std::string parameter, std::string metric,
+	          double value, std::string unit ) {
+		m_rows.push_back( {std::move( benchmark ), std::move( parameter ),
+		                   std::move( metric ), value, std::move( unit )} );
+	}
+};
+
+template<typename Function>
+double time_seconds( Function &&func ) {
+	auto const start = std::chrono::steady_clock::now( );
+	func( );
+	auto const finish = std::chrono::steady_clock::now( );
+	return std::chrono::duration<double>( finish - start ).count( );
+}
@@ -0,0 +1,448 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sched.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "bench_report.h"
+#include "daw/daw_barrier.h"
+#include "daw/daw_broadcast_channel.h"
+#include "daw/daw_channel.h"
+#include "daw/daw_collection_channel.h"
+#include "daw/daw_future_process.h"
+#include "daw/daw_process.h"
+#include "daw/daw_semaphore.h"
+#include "daw/daw_shared_memory.h"
+#include "daw/daw_shared_mutex.h"
+#include "daw/daw_string_channel.h"
+
+// Latency, throughput and contention of the IPC primitives.  Run with --json
+// for JSON instead of CSV output
+
+static constexpr double ns_per_s = 1'000'000'000.0;
+static constexpr double bytes_per_mib = 1024.0 * 1024.0;
+
+static void semaphore_ping_pong( bench_report &report ) {
+	static constexpr size_t iterations = 20'000;
+	auto ping = daw::process::semaphore( );
+	auto pong = daw::process::semaphore( );
+	auto const secs = time_seconds( [&] {
+		auto proc = daw::process::fork_process( [&] {
+			for( size_t n = 0; n < iterations; ++n ) {
+				ping.wait( );
+				pong.post( );
+			}
+		} );
+		for( size_t n = 0; n < iterations; ++n ) {
+			ping.post( );
+			pong.wait( );
+		}
+	} );
+	report.add( "semaphore_ping_pong", "", "round_trip",
+	            secs * ns_per_s / iterations, "ns" );
+}
+
+template<size_t PayloadSize>
+static void channel_round_trip( bench_report &report ) {
+	static constexpr size_t iterations = 10'000;
+	using payload_t = std::array<char, PayloadSize>;
+	auto request = daw::process::channel<payload_t>( );
+	auto response = daw::process::channel<payload_t>( );
+	auto const secs = time_seconds( [&] {
+		auto proc = daw::process::fork_process( [&] {
+			for( size_t n = 0; n < iterations; ++n ) {
+				response.write( request.read( ) );
+			}
+		} );
+		auto msg = payload_t{};
+		for( size_t n = 0; n < iterations; ++n ) {
+			request.write( msg );
+			msg = response.read( );
+		}
+	} );
+	report.add( "channel_round_trip", std::to_string( PayloadSize ),
+	            "round_trip", secs * ns_per_s / iterations, "ns" );
+}
+
+// The value of /sys/devices/system/cpu/cpuN/topology/name, or -1
+static int cpu_topology( int cpu, char const *name ) {
+	auto file = std::ifstream( "/sys/devices/system/cpu/cpu" +
+	                           std::to_string( cpu ) + "/topology/" + name );
+	int result = -1;
+	file >> result;
+	return result;
+}
+
+// Pairs of CPUs to pin the two sides of a channel to, placements the
+// machine cannot provide are left out
+static std::vector<std::pair<std::string, std::array<int, 2>>>
+channel_placements( ) {
+	auto cpus = std::vector<int>( );
+	cpu_set_t set;
+	CPU_ZERO( &set );
+	sched_getaffinity( 0, sizeof( set ), &set );
+	for( int cpu = 0; cpu < CPU_SETSIZE; ++cpu ) {
+		if( CPU_ISSET( cpu, &set ) ) {
+			cpus.push_back( cpu );
+		}
+	}
+	auto result = std::vector<std::pair<std::string, std::array<int, 2>>>( );
+	if( cpus.empty( ) ) {
+		return result;
+	}
+	auto const first = cpus.front( );
+	auto const package = cpu_topology( first, "physical_package_id" );
+	auto const core = cpu_topology( first, "core_id" );
+	result.emplace_back( "same_cpu", std::array<int, 2>{first, first} );
+	auto const find = [&]( auto pred ) -> std::optional<int> {
+		for( auto cpu : cpus ) {
+			if( cpu != first and pred( cpu_topology( cpu, "physical_package_id" ),
+			                           cpu_topology( cpu, "core_id" ) ) ) {
+				return cpu;
+			}
+		}
+		return std::nullopt;
+	};
+	if( auto cpu = find( [&]( int p, int c ) {
+		    return p == package and c == core;
+	    } ) ) {
+		result.emplace_back( "same_core", std::array<int, 2>{first, *cpu} );
+	}
+	if( auto cpu = find( [&]( int p, int c ) {
+		    return p == package and c != core;
+	    } ) ) {
+		result.emplace_back( "same_socket", std::array<int, 2>{first, *cpu} );
+	}
+	if( auto cpu = find( [&]( int p, int ) { return p != package; } ) ) {
+		result.emplace_back( "cross_socket", std::array<int, 2>{first, *cpu} );
+	}
+	return result;
+}
+
+// Round trips of 64 byte messages with each side pinned by launch_options
+static void channel_placement( bench_report &report, std::string const &name,
+                               std::array<int, 2> const &cpus ) {
+	static constexpr size_t iterations = 10'000;
+	using payload_t = std::array<char, 64>;
+	auto request = daw::process::channel<payload_t>( );
+	auto response = daw::process::channel<payload_t>( );
+	auto secs = daw::process::shared_memory<double>( );
+	auto server_opts = daw::process::launch_options{};
+	server_opts.cpus = {cpus[0]};
+	auto client_opts = daw::process::launch_options{};
+	client_opts.cpus = {cpus[1]};
+	{
+		auto server = daw::process::fork_process( server_opts, [&] {
+			for( size_t n = 0; n < iterations; ++n ) {
+				response.write( request.read( ) );
+			}
+		} );
+		auto client = daw::process::fork_process( client_opts, [&] {
+			auto msg = payload_t{};
+			secs.write( time_seconds( [&] {
+				for( size_t n = 0; n < iterations; ++n ) {
+					request.write( msg );
+					msg = response.read( );
+				}
+			} ) );
+		} );
+	}
+	report.add( "channel_placement", name, "round_trip",
+	            secs.read( ) * ns_per_s / iterations, "ns" );
+}
+
+template<size_t PayloadSize>
+static void channel_throughput( bench_report &report ) {
+	static constexpr size_t iterations = 20'000;
+	using payload_t = std::array<char, PayloadSize>;
+	auto chan = daw::process::channel<payload_t>( );
+	auto const secs = time_seconds( [&] {
+		auto proc = daw::process::fork_process( [&] {
+			auto const msg = payload_t{};
+			for( size_t n = 0; n < iterations; ++n ) {
+				chan.write( msg );
+			}
+		} );
+		for( size_t n = 0; n < iterations; ++n ) {
+			(void)chan.read( );
+		}
+	} );
+	auto const param = std::to_string( PayloadSize );
+	report.add( "channel_throughput", param, "messages", iterations / secs,
+	            "msg/s" );
+	report.add( "channel_throughput", param, "bandwidth",
+	            iterations * PayloadSize / secs / bytes_per_mib, "MiB/s" );
+}
+
+// write_n/read_n of 16 byte values, one synchronization per batch
+static void channel_batch_throughput( bench_report &report ) {
+	static constexpr size_t iterations = 1'000'000;
+	using payload_t = std::array<char, 16>;
+	auto chan = daw::process::channel<payload_t>( );
+	auto const secs = time_seconds( [&] {
+		auto proc = daw::process::fork_process( [&] {
+			chan.write_n( std::vector<payload_t>( iterations ) );
+		} );
+		auto values = std::vector<payload_t>( iterations );
+		chan.read_n( values );
+	} );
+	auto const param = std::to_string( chan.batch_capacity( ) );
+	report.add( "channel_batch_throughput", param, "messages",
+	            iterations / secs, "msg/s" );
+	report.add( "channel_batch_throughput", param, "bandwidth",
+	            iterations * sizeof( payload_t ) / secs / bytes_per_mib,
+	            "MiB/s" );
+}
+
+static void collection_channel_bandwidth( bench_report &report ) {
+	static constexpr size_t items_per_message = 64U * 1024U / sizeof( int64_t );
+	static constexpr size_t item_count = 4U * 1024U * 1024U;
+	static constexpr size_t repeats = 4;
+	auto chan =
+	  daw::process::collection_channel<int64_t>( items_per_message );
+	auto const values = std::vector<int64_t>( item_count, 42 );
+	auto const secs = time_seconds( [&] {
+		auto proc = daw::process::fork_process( [&] {
+			for( size_t n = 0; n < repeats; ++n ) {
+				chan.write( values );
+			}
+		} );
+		for( size_t n = 0; n < repeats; ++n ) {
+			daw::expecting( chan.read( ).size( ), item_count );
+		}
+	} );
+	report.add( "collection_channel_bandwidth", "64KiB", "bandwidth",
+	            repeats * item_count * sizeof( int64_t ) / secs / bytes_per_mib,
+	            "MiB/s" );
+}
+
+static void string_channel_bandwidth( bench_report &report ) {
+	static constexpr size_t chars_per_message = 64U * 1024U;
+	static constexpr size_t char_count = 32U * 1024U * 1024U;
+	static constexpr size_t repeats = 4;
+	auto chan = daw::process::string_channel<char>( chars_per_message );
+	auto const str = std::string( char_count, 'a' );
+	auto const secs = time_seconds( [&] {
+		auto proc = daw::process::fork_process( [&] {
+			for( size_t n = 0; n < repeats; ++n ) {
+				chan.write( str );
+			}
+		} );
+		for( size_t n = 0; n < repeats; ++n ) {
+			daw::expecting( chan.read( ).size( ), char_count );
+		}
+	} );
+	report.add( "string_channel_bandwidth", "64KiB", "bandwidth",
+	            repeats * char_count / secs / bytes_per_mib, "MiB/s" );
+}
+
+// Each of reader_count readers receives every value, once through a
+// broadcast_channel and once through a channel per reader
+static void fan_out( bench_report &report, size_t reader_count ) {
+	static constexpr size_t iterations = 20'000;
+	using payload_t = std::array<char, 64>;
+	auto const param = std::to_string( reader_count );
+
+	auto bchan = daw::process::broadcast_channel<payload_t, 256, 16>( );
+	auto subscribed = daw::process::semaphore( );
+	auto readers = std::vector<daw::process::fork_process<>>( );
+	for( size_t n = 0; n < reader_count; ++n ) {
+		readers.emplace_back( [&] {
+			auto sub = bchan.subscribe( );
+			subscribed.post( );
+			for( size_t i = 0; i < iterations; ++i ) {
+				(void)sub.read( );
+			}
+		} );
+	}
+	for( size_t n = 0; n < reader_count; ++n ) {
+		subscribed.wait( );
+	}
+	auto secs = time_seconds( [&] {
+		auto const msg = payload_t{};
+		for( size_t i = 0; i < iterations; ++i ) {
+			bchan.write( msg );
+		}
+		readers.clear( );
+	} );
+	report.add( "broadcast_fan_out", param, "published", iterations / secs,
+	            "msg/s" );
+
+	auto chans = std::vector<daw::process::channel<payload_t>>( reader_count );
+	for( size_t n = 0; n < reader_count; ++n ) {
+		readers.emplace_back( [&chan = chans[n]] {
+			for( size_t i = 0; i < iterations; ++i ) {
+				(void)chan.read( );
+			}
+		} );
+	}
+	secs = time_seconds( [&] {
+		auto const msg = payload_t{};
+		for( size_t i = 0; i < iterations; ++i ) {
+			for( auto &chan : chans ) {
+				chan.write( msg );
+			}
+		}
+		readers.clear( );
+	} );
+	report.add( "channel_fan_out", param, "published", iterations / secs,
+	            "msg/s" );
+}
+
+// Phase boundaries between process_count processes, with a barrier and with
+// a coordinator posting a semaphore per process and waiting for each of them
+static void phase_boundary( bench_report &report, size_t process_count ) {
+	static constexpr size_t phases = 2'000;
+	auto const param = std::to_string( process_count );
+
+	auto sync = daw::process::barrier(
+	  static_cast<std::ptrdiff_t>( process_count ) + 1 );
+	auto procs = std::vector<daw::process::fork_process<>>( );
+	for( size_t n = 0; n < process_count; ++n ) {
+		procs.emplace_back( [&] {
+			for( size_t i = 0; i < phases; ++i ) {
+				sync.arrive_and_wait( );
+			}
+		} );
+	}
+	auto secs = time_seconds( [&] {
+		for( size_t i = 0; i < phases; ++i ) {
+			sync.arrive_and_wait( );
+		}
+	} );
+	procs.clear( );
+	report.add( "phase_boundary_barrier", param, "phases", phases / secs,
+	            "phases/s" );
+
+	auto go = std::vector<daw::process::semaphore>( process_count );
+	auto done = daw::process::semaphore( );
+	for( size_t n = 0; n < process_count; ++n ) {
+		procs.emplace_back( [&sem = go[n], &done] {
+			for( size_t i = 0; i < phases; ++i ) {
+				sem.wait( );
+				done.post( );
+			}
+		} );
+	}
+	secs = time_seconds( [&] {
+		for( size_t i = 0; i < phases; ++i ) {
+			for( auto &sem : go ) {
+				sem.post( );
+			}
+			for( size_t n = 0; n < process_count; ++n ) {
+				done.wait( );
+			}
+		}
+	} );
+	procs.clear( );
+	report.add( "phase_boundary_semaphores", param, "phases", phases / secs,
+	            "phases/s" );
+}
+
+static void async_latency( bench_report &report ) {
+	static constexpr size_t iterations = 200;
+	auto const secs = time_seconds( [&] {
+		for( size_t n = 0; n < iterations; ++n ) {
+			daw::expecting( daw::process::async( []( size_t v ) { return v; }, n )
+			                  .get( ),
+			                n );
+		}
+	} );
+	report.add( "async_latency", "", "spawn_to_result",
+	            secs * ns_per_s / iterations / 1000.0, "us" );
+}
+
+static void shared_mutex_contention( bench_report &report,
+                                     size_t process_count ) {
+	static constexpr size_t total_locks = 200'000;
+	auto const locks_per_process = total_locks / process_count;
+	auto mtx = daw::process::shared_mutex( );
+	auto counter = daw::process::shared_memory<size_t>( );
+	auto start = daw::process::semaphore( );
+	auto procs = std::vector<daw::process::fork_process<>>( );
+	for( size_t n = 0; n < process_count; ++n ) {
+		procs.emplace_back( [&] {
+			start.wait( );
+			for( size_t i = 0; i < locks_per_process; ++i ) {
+				auto lck = std::lock_guard( mtx );
+				++*counter.data( );
+			}
+		} );
+	}
+	auto const secs = time_seconds( [&] {
+		for( size_t n = 0; n < process_count; ++n ) {
+			start.post( );
+		}
+		procs.clear( );
+	} );
+	daw::expecting( counter.read( ), locks_per_process * process_count );
+	report.add( "shared_mutex_contention", std::to_string( process_count ),
+	            "locks", locks_per_process * process_count / secs, "locks/s" );
+}
+
+int main( int argc, char **argv ) {
+	auto report = bench_report( argc, argv );
+
+	semaphore_ping_pong( report );
+
+	channel_round_trip<8>( report );
+	channel_round_trip<64>( report );
+	channel_round_trip<512>( report );
+	channel_round_trip<4096>( report );
+
+	for( auto const &[name, cpus] : channel_placements( ) ) {
+		channel_placement( report, name, cpus );
+	}
+
+	channel_throughput<8>( report );
+	channel_throughput<64>( report );
+	channel_throughput<512>( report );
+	channel_throughput<4096>( report );
+	channel_batch_throughput( report );
+
+	collection_channel_bandwidth( report );
+	string_channel_bandwidth( report );
+
+	for( size_t reader_count : {1U, 4U, 12U} ) {
+		fan_out( report, reader_count );
+	}
+
+	for( size_t process_count : {2U, 4U, 12U} ) {
+		phase_boundary( report, process_count );
+	}
+
+	async_latency( report );
+
+	for( size_t process_count : {2U, 4U, 8U, 16U, 32U, 64U} ) {
+		shared_mutex_contention( report, process_count );
+	}
+}
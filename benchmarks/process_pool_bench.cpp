@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <iostream>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_future_process.h"
+#include "daw/daw_process_pool.h"
+
+template<typename Function>
+static double tasks_per_second( size_t task_count, Function &&func ) {
+	auto const start = std::chrono::steady_clock::now( );
+	func( );
+	auto const finish = std::chrono::steady_clock::now( );
+	auto const secs = std::chrono::duration<double>( finish - start ).count( );
+	return static_cast<double>( task_count ) / secs;
+}
+
+int main( ) {
+	static constexpr size_t task_count = 1'000;
+	auto const work = []( size_t n ) { return n * n; };
+
+	auto const fork_rate = tasks_per_second( task_count, [&] {
+		std::vector<std::future<size_t>> futs{};
+		futs.reserve( task_count );
+		for( size_t n = 0; n < task_count; ++n ) {
+			futs.push_back( daw::process::async( work, n ) );
+		}
+		for( size_t n = 0; n < task_count; ++n ) {
+			daw::expecting( futs[n].get( ), n * n );
+		}
+	} );
+	std::cout << "fork per call: " << fork_rate << " tasks/s" << std::endl;
+
+	auto pool = daw::process::process_pool( );
+	auto const pool_rate = tasks_per_second( task_count, [&] {
+		std::vector<std::future<size_t>> futs{};
+		futs.reserve( task_count );
+		for( size_t n = 0; n < task_count; ++n ) {
+			futs.push_back( pool.async( work, n ) );
+		}
+		for( size_t n = 0; n < task_count; ++n ) {
+			daw::expecting( futs[n].get( ), n * n );
+		}
+	} );
+	std::cout << "process_pool(" << pool.size( ) << "): " << pool_rate
+	          << " tasks/s" << std::endl;
+}
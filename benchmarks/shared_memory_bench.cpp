@@ -0,0 +1,63 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string_view>
+
+#include "daw/daw_shared_memory.h"
+
+static constexpr size_t buffer_size = 256U * 1024U * 1024U;
+static constexpr size_t page_size = 4096U;
+using buffer_t = std::array<char, buffer_size>;
+
+static void bench( std::string_view name,
+                   daw::process::shared_memory_options const &opts ) {
+	auto const map_start = std::chrono::steady_clock::now( );
+	auto mem = daw::process::shared_memory<buffer_t>( opts );
+	auto const touch_start = std::chrono::steady_clock::now( );
+	auto *ptr = mem.data( )->data( );
+	for( size_t n = 0; n < buffer_size; n += page_size ) {
+		ptr[n] = 1;
+	}
+	auto const touch_end = std::chrono::steady_clock::now( );
+	using ms = std::chrono::duration<double, std::milli>;
+	std::cout << name << ",map_ms," << ms( touch_start - map_start ).count( )
+	          << ",first_touch_ms," << ms( touch_end - touch_start ).count( )
+	          << '\n';
+}
+
+int main( ) {
+	using daw::process::huge_pages;
+	using daw::process::shared_memory_options;
+
+	bench( "default", shared_memory_options{} );
+	bench( "populate", shared_memory_options{true, huge_pages::none} );
+	bench( "transparent", shared_memory_options{false, huge_pages::transparent} );
+	bench( "transparent_populate",
+	       shared_memory_options{true, huge_pages::transparent} );
+	bench( "hugetlb", shared_memory_options{false, huge_pages::hugetlb} );
+	bench( "numa_node_0",
+	       shared_memory_options{true, huge_pages::none, false, 0} );
+}
@@ -0,0 +1,111 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "bench_report.h"
+#include "daw/daw_future_process.h"
+#include "daw/daw_process.h"
+#include "daw/daw_zygote.h"
+
+// Spawn latency of fork_spawn, vfork_spawn and a zygote as the parent's RSS
+// grows.  Run with --json for JSON instead of CSV output
+
+static constexpr size_t iterations = 100;
+
+// Time each of iterations calls to func and report the mean and p99 in us
+template<typename Function>
+static void spawn_latency( bench_report &report, std::string const &name,
+                           std::string const &parameter, Function &&func ) {
+	auto times = std::vector<double>( );
+	times.reserve( iterations );
+	for( size_t n = 0; n < iterations; ++n ) {
+		times.push_back( time_seconds( func ) * 1'000'000.0 );
+	}
+	std::sort( times.begin( ), times.end( ) );
+	auto const mean = [&] {
+		double sum = 0.0;
+		for( auto t : times ) {
+			sum += t;
+		}
+		return sum / static_cast<double>( times.size( ) );
+	}( );
+	report.add( name, parameter, "mean", mean, "us" );
+	report.add( name, parameter, "p99", times[times.size( ) * 99 / 100], "us" );
+}
+
+template<typename SpawnPolicy>
+static void spawn_policy( bench_report &report, std::string const &policy,
+                          std::string const &rss ) {
+	spawn_latency( report, policy + "_join", rss, [] {
+		auto proc = daw::process::fork_process<true, SpawnPolicy>( [] {} );
+	} );
+	spawn_latency( report, policy + "_exec", rss, [] {
+		auto proc = daw::process::fork_process<true, SpawnPolicy>( [] {
+			execl( "/bin/true", "true", static_cast<char *>( nullptr ) );
+		} );
+	} );
+	if constexpr( not std::is_same_v<SpawnPolicy, daw::process::vfork_spawn> ) {
+		spawn_latency( report, policy + "_async", rss, [] {
+			daw::expecting(
+			  daw::process::async<SpawnPolicy>( []( int v ) { return v; }, 1 ).get( ),
+			  1 );
+		} );
+	}
+}
+
+static int identity( int v ) {
+	return v;
+}
+
+static void zygote_spawn( bench_report &report, daw::process::zygote &zyg,
+                          std::string const &rss ) {
+	spawn_latency( report, "zygote_join", rss,
+	               [&] { auto proc = zyg.spawn( +[] {} ); } );
+	spawn_latency( report, "zygote_async", rss, [&] {
+		daw::expecting( zyg.async( &identity, 1 ).get( ), 1 );
+	} );
+}
+
+int main( int argc, char **argv ) {
+	auto report = bench_report( argc, argv );
+	// Created before the ballast, like it would be at startup
+	auto zyg = daw::process::zygote( );
+	for( size_t rss_mib : {0U, 256U, 1024U, 2048U} ) {
+		// Touch every page so that it is part of the RSS a fork has to copy
+		auto ballast = std::vector<char>( rss_mib * 1024U * 1024U );
+		memset( ballast.data( ), 1, ballast.size( ) );
+		auto const rss = std::to_string( rss_mib ) + "MiB";
+		spawn_policy<daw::process::fork_spawn>( report, "fork_spawn", rss );
+		spawn_policy<daw::process::vfork_spawn>( report, "vfork_spawn", rss );
+		zygote_spawn( report, zyg, rss );
+	}
+}
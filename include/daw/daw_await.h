@@ -0,0 +1,343 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// C++20 coroutine support, enabled when the compiler and library provide it.
+// Waiting coroutines are parked with service threads that each wait on the
+// futexes of up to 127 of them at once with futex_waitv
+#include "daw_await_fwd.h"
+
+#if defined( DAW_PROCESS_HAS_COROUTINES )
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+#include "daw_futex.h"
+
+#if defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace daw::process {
+	// Resumes the coroutine on the thread that saw it become ready.  For
+	// async_wait, async_read and async_write that is one of the library's
+	// await service threads, for async_task the process_reaper's thread, so
+	// the coroutine moves to that thread and until it suspends again no other
+	// waiting coroutine there is resumed.  Any callable taking a
+	// std::coroutine_handle<> can be used instead, e.g. one that posts it to an
+	// event loop
+	struct inline_executor {
+		void operator( )( std::coroutine_handle<> handle ) const {
+			handle.resume( );
+		}
+	};
+
+	namespace impl {
+		// A coroutine waiting for a semaphore count to become non-zero
+		struct await_entry_base {
+			std::atomic<uint32_t> *m_count;
+			std::atomic<uint32_t> *m_waiters;
+
+			await_entry_base( std::atomic<uint32_t> *count,
+			                  std::atomic<uint32_t> *waiters ) noexcept
+			  : m_count( count )
+			  , m_waiters( waiters ) {}
+
+			virtual ~await_entry_base( ) = default;
+			// Take what is waited for, if it is there
+			virtual bool try_complete( ) = 0;
+			virtual void resume( ) = 0;
+		};
+
+		template<typename TryComplete, typename Resume>
+		struct await_entry final : await_entry_base {
+			TryComplete m_try_complete;
+			Resume m_resume;
+
+			await_entry( std::atomic<uint32_t> *count, std::atomic<uint32_t> *waiters,
+			             TryComplete try_complete, Resume resume )
+			  : await_entry_base( count, waiters )
+			  , m_try_complete( std::move( try_complete ) )
+			  , m_resume( std::move( resume ) ) {}
+
+			bool try_complete( ) override {
+				return m_try_complete( );
+			}
+
+			void resume( ) override {
+				m_resume( );
+			}
+		};
+
+		// Up to group_capacity waiting coroutines and the thread that waits on
+		// their futexes with one futex_waitv.  Only the group's thread touches
+		// m_pending, new entries are handed over through m_incoming
+		class await_group {
+		public:
+			// The kernel limit for futex_waitv is 128, one is used for
+			// m_generation
+			static constexpr size_t group_capacity = 127;
+
+		private:
+			std::mutex m_mutex{};
+			std::vector<std::unique_ptr<await_entry_base>> m_incoming{};
+			// Changed whenever an entry is added so that the thread wakes
+			std::atomic<uint32_t> m_generation{0};
+			// Entries added and not yet resumed, only raised by await_service
+			std::atomic<size_t> m_size{0};
+
+			static constexpr std::ptrdiff_t woken_by_add = -1;
+			static constexpr std::ptrdiff_t woken_by_unknown = -2;
+
+			// Wait for the generation or one of the counts to change.  Returns the
+			// index into counts that woke, woken_by_add or woken_by_unknown
+			std::ptrdiff_t
+			wait_for_any( std::vector<std::atomic<uint32_t> *> const &counts,
+			              uint32_t generation ) {
+#if defined( SYS_futex_waitv ) and defined( FUTEX_32 )
+				auto waiters = std::array<futex_waitv, group_capacity + 1>{};
+				auto const to_waitv = []( std::atomic<uint32_t> *addr,
+				                          uint32_t expected ) {
+					auto result = futex_waitv{};
+					result.val = expected;
+					result.uaddr = reinterpret_cast<uintptr_t>( addr );
+					result.flags = FUTEX_32;
+					return result;
+				};
+				waiters[0] = to_waitv( &m_generation, generation );
+				for( size_t n = 0; n < counts.size( ); ++n ) {
+					waiters[n + 1] = to_waitv( counts[n], 0 );
+				}
+				auto const result =
+				  syscall( SYS_futex_waitv, waiters.data( ),
+				           static_cast<unsigned>( counts.size( ) + 1 ), 0U, nullptr,
+				           CLOCK_MONOTONIC );
+				if( result >= 0 ) {
+					return static_cast<std::ptrdiff_t>( result ) - 1;
+				}
+				if( errno != ENOSYS ) {
+					// A value had already changed or a signal interrupted the wait
+					return woken_by_unknown;
+				}
+#else
+				(void)counts;
+				(void)generation;
+#endif
+				// No way to wait on several futexes, poll
+				auto const ts = timespec{0, 100'000};
+				nanosleep( &ts, nullptr );
+				return woken_by_unknown;
+			}
+
+			void run( ) {
+				auto pending = std::vector<std::unique_ptr<await_entry_base>>( );
+				auto incoming = std::vector<std::unique_ptr<await_entry_base>>( );
+				auto ready = std::vector<std::unique_ptr<await_entry_base>>( );
+				auto counts = std::vector<std::atomic<uint32_t> *>( );
+				// The count that woke the thread, when it is known
+				std::atomic<uint32_t> *woken = nullptr;
+				bool check_all = false;
+				while( true ) {
+					auto const generation =
+					  m_generation.load( std::memory_order_seq_cst );
+					{
+						auto const lck = std::lock_guard( m_mutex );
+						incoming.swap( m_incoming );
+					}
+					// Posts made before an entry was counted as a waiter woke no one
+					for( auto &entry : incoming ) {
+						if( entry->try_complete( ) ) {
+							ready.push_back( std::move( entry ) );
+						} else {
+							pending.push_back( std::move( entry ) );
+						}
+					}
+					incoming.clear( );
+					if( check_all or woken != nullptr ) {
+						auto pos = std::partition(
+						  pending.begin( ), pending.end( ), [&]( auto const &entry ) {
+							  return !( check_all or entry->m_count == woken ) or
+							         !entry->try_complete( );
+						  } );
+						std::move( pos, pending.end( ), std::back_inserter( ready ) );
+						pending.erase( pos, pending.end( ) );
+					}
+					if( !ready.empty( ) ) {
+						m_size.fetch_sub( ready.size( ), std::memory_order_seq_cst );
+						for( auto &entry : ready ) {
+							entry->m_waiters->fetch_sub( 1, std::memory_order_relaxed );
+							entry->resume( );
+						}
+						ready.clear( );
+					}
+					// A count that changed while nothing waited is seen by futex_waitv,
+					// which then returns without saying which one it was
+					counts.clear( );
+					for( auto const &entry : pending ) {
+						counts.push_back( entry->m_count );
+					}
+					auto const index = wait_for_any( counts, generation );
+					woken = index >= 0 ? counts[static_cast<size_t>( index )] : nullptr;
+					check_all = index == woken_by_unknown;
+				}
+			}
+
+		public:
+			await_group( ) {
+				std::thread( [this] { run( ); } ).detach( );
+			}
+
+			await_group( await_group const & ) = delete;
+			await_group &operator=( await_group const & ) = delete;
+
+			// Only called by await_service, with a free slot reserved in m_size
+			void add( std::unique_ptr<await_entry_base> entry ) {
+				{
+					auto const lck = std::lock_guard( m_mutex );
+					m_incoming.push_back( std::move( entry ) );
+				}
+				m_generation.fetch_add( 1, std::memory_order_seq_cst );
+				futex_wake( &m_generation, 1 );
+			}
+
+			// Reserve a slot for an entry, fails when the group is full
+			bool try_reserve( ) noexcept {
+				auto size = m_size.load( std::memory_order_seq_cst );
+				while( size < group_capacity ) {
+					if( m_size.compare_exchange_weak( size, size + 1,
+					                                  std::memory_order_seq_cst ) ) {
+						return true;
+					}
+				}
+				return false;
+			}
+		};
+
+		// Parks waiting coroutines in groups, a thread per group_capacity of
+		// them, so that every futex is waited on and none are polled.  Groups
+		// are kept for the life of the process and reused as they empty
+		class await_service {
+			std::mutex m_mutex{};
+			std::vector<std::unique_ptr<await_group>> m_groups{};
+			::pid_t m_owner = getpid( );
+
+			await_service( ) = default;
+
+		public:
+			await_service( await_service const & ) = delete;
+			await_service &operator=( await_service const & ) = delete;
+
+			// Like the process_reaper, each process gets its own instance
+			static await_service &get( ) {
+				static std::mutex s_mutex{};
+				static await_service *s_service = nullptr;
+				auto const lck = std::lock_guard( s_mutex );
+				if( !s_service or s_service->m_owner != getpid( ) ) {
+					s_service = new await_service( );
+				}
+				return *s_service;
+			}
+
+			void add( std::unique_ptr<await_entry_base> entry ) {
+				// Counted as a waiter so that posts wake the service
+				entry->m_waiters->fetch_add( 1, std::memory_order_seq_cst );
+				auto *group = [&] {
+					auto const lck = std::lock_guard( m_mutex );
+					for( auto &g : m_groups ) {
+						if( g->try_reserve( ) ) {
+							return g.get( );
+						}
+					}
+					m_groups.push_back( std::make_unique<await_group>( ) );
+					(void)m_groups.back( )->try_reserve( );
+					return m_groups.back( ).get( );
+				}( );
+				group->add( std::move( entry ) );
+			}
+		};
+	} // namespace impl
+
+	// Awaits a semaphore like count.  try_acquire( ) returns a bool or a
+	// std::optional that is the result of the co_await.  The object that owns
+	// the count must outlive the co_await
+	template<typename TryAcquire, typename Executor>
+	class [[nodiscard]] semaphore_awaitable {
+		using result_t = std::invoke_result_t<TryAcquire &>;
+
+		std::atomic<uint32_t> *m_count;
+		std::atomic<uint32_t> *m_waiters;
+		TryAcquire m_try_acquire;
+		Executor m_executor;
+		result_t m_result{};
+
+		bool try_acquire( ) {
+			m_result = m_try_acquire( );
+			return static_cast<bool>( m_result );
+		}
+
+	public:
+		semaphore_awaitable( std::atomic<uint32_t> *count,
+		                     std::atomic<uint32_t> *waiters,
+		                     TryAcquire try_acquire, Executor executor )
+		  : m_count( count )
+		  , m_waiters( waiters )
+		  , m_try_acquire( std::move( try_acquire ) )
+		  , m_executor( std::move( executor ) ) {}
+
+		bool await_ready( ) {
+			return try_acquire( );
+		}
+
+		void await_suspend( std::coroutine_handle<> handle ) {
+			auto try_complete = [this] { return try_acquire( ); };
+			auto resume = [this, handle] { m_executor( handle ); };
+			impl::await_service::get( ).add(
+			  std::make_unique<impl::await_entry<decltype( try_complete ),
+			                                     decltype( resume )>>(
+			    m_count, m_waiters, std::move( try_complete ),
+			    std::move( resume ) ) );
+		}
+
+		auto await_resume( ) {
+			if constexpr( !std::is_same_v<result_t, bool> ) {
+				return std::move( *m_result );
+			}
+		}
+	};
+} // namespace daw::process
+#endif
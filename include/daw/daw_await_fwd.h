@@ -0,0 +1,41 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Declarations for the co_await members of semaphore and channel, so that
+// those headers do not pull in the coroutine machinery and its threads.
+// Include daw_await.h to use them
+#if defined( __has_include )
+#if __has_include( <coroutine> ) and defined( __cpp_impl_coroutine )
+#define DAW_PROCESS_HAS_COROUTINES
+#endif
+#endif
+
+#if defined( DAW_PROCESS_HAS_COROUTINES )
+namespace daw::process {
+	struct inline_executor;
+
+	template<typename TryAcquire, typename Executor>
+	class semaphore_awaitable;
+} // namespace daw::process
+#endif
@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "daw_futex.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		struct barrier_state {
+			// The epoch is the phase, it is bumped by the last arrival
+			waiters_t m_phase;
+			std::atomic<uint32_t> m_remaining;
+			std::atomic<uint32_t> m_expected;
+		};
+	} // namespace impl
+
+	// A reusable barrier in anonymous shared memory.  The last process to
+	// arrive starts the next phase and wakes the others with one futex wake
+	class barrier {
+		daw::process::shared_memory<impl::barrier_state> m_state{};
+
+		impl::barrier_state &state( ) noexcept {
+			return *m_state.data( );
+		}
+
+	public:
+		using arrival_token = uint32_t;
+
+		explicit barrier( std::ptrdiff_t expected ) noexcept {
+			auto &st = state( );
+			st.m_remaining.store( static_cast<uint32_t>( expected ),
+			                      std::memory_order_relaxed );
+			st.m_expected.store( static_cast<uint32_t>( expected ),
+			                     std::memory_order_release );
+		}
+
+		[[nodiscard]] arrival_token arrive( ) noexcept {
+			auto &st = state( );
+			auto const phase = st.m_phase.m_epoch.load( std::memory_order_acquire );
+			if( st.m_remaining.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+				st.m_remaining.store( st.m_expected.load( std::memory_order_relaxed ),
+				                      std::memory_order_relaxed );
+				impl::notify_all( st.m_phase );
+			}
+			return phase;
+		}
+
+		void wait( arrival_token phase ) noexcept {
+			auto &st = state( );
+			impl::wait_until( st.m_phase, [&] {
+				return st.m_phase.m_epoch.load( std::memory_order_acquire ) != phase;
+			} );
+		}
+
+		void arrive_and_wait( ) noexcept {
+			wait( arrive( ) );
+		}
+
+		// Arrive and take this process out of the following phases
+		void arrive_and_drop( ) noexcept {
+			state( ).m_expected.fetch_sub( 1, std::memory_order_relaxed );
+			(void)arrive( );
+		}
+	};
+} // namespace daw::process
@@ -0,0 +1,269 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <sys/types.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+#include <daw/daw_exception.h>
+
+#include "daw_futex.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		struct broadcast_cursor_t {
+			// The next value the subscriber reads
+			alignas( cache_line_size ) std::atomic<size_t> m_position;
+			// The pid of the subscribed process, 0 when the cursor is free
+			std::atomic<::pid_t> m_owner;
+		};
+
+		template<typename T, size_t Capacity, size_t MaxSubscribers>
+		struct broadcast_t {
+			// Owned by the writer
+			alignas( cache_line_size ) std::atomic<size_t> m_published;
+			size_t m_slowest_cache;
+			alignas( cache_line_size ) waiters_t m_readers;
+			alignas( cache_line_size ) waiters_t m_writer;
+			std::array<broadcast_cursor_t, MaxSubscribers> m_cursors;
+			alignas( cache_line_size ) std::array<T, Capacity> m_values;
+		};
+	} // namespace impl
+
+	// A single writer channel where every value is delivered to every
+	// subscriber.  The writer publishes each value once into a ring and each
+	// subscriber follows it with its own cursor, the writer waits when it
+	// would overwrite a value the slowest subscriber has not read.  Subscribe
+	// from the process that reads, after fork, and only values written after
+	// subscribe( ) are seen.  A subscriber must not outlive the channel object
+	// it came from, in its own process.  When a subscriber's process exits
+	// without destroying it, the writer frees its cursor once it blocks the
+	// writer.  A subscriber that stops reading in a live process stalls the
+	// writer
+	template<typename T, size_t Capacity = 64, size_t MaxSubscribers = 16>
+	class broadcast_channel {
+		static_assert( std::is_trivially_copyable_v<T> );
+		static_assert( std::is_default_constructible_v<T> );
+		static_assert( Capacity > 0 );
+		static_assert( MaxSubscribers > 0 );
+
+		using ring_t = impl::broadcast_t<T, Capacity, MaxSubscribers>;
+
+		daw::process::shared_memory<ring_t> m_ring{};
+
+		ring_t &ring( ) noexcept {
+			return *m_ring.data( );
+		}
+
+		// The lowest position of the active subscribers, or published when there
+		// are none
+		static size_t slowest( ring_t &r, size_t published ) noexcept {
+			auto result = published;
+			for( auto &cursor : r.m_cursors ) {
+				if( cursor.m_owner.load( std::memory_order_seq_cst ) != 0 ) {
+					auto const pos = cursor.m_position.load( std::memory_order_seq_cst );
+					if( published - pos > published - result ) {
+						result = pos;
+					}
+				}
+			}
+			return result;
+		}
+
+		// A dead subscriber never notifies the writer, so a blocked writer looks
+		// for one this often
+		static constexpr auto dead_check_interval = timespec{0, 10'000'000};
+
+		// Free the cursors holding back the writer whose process exited without
+		// releasing them.  Only those are checked, as each check is a system
+		// call.  Returns whether any was freed
+		bool release_dead( ) noexcept {
+			auto &r = ring( );
+			auto const position = r.m_slowest_cache;
+			bool result = false;
+			for( auto &cursor : r.m_cursors ) {
+				auto owner = cursor.m_owner.load( std::memory_order_seq_cst );
+				if( owner != 0 and
+				    cursor.m_position.load( std::memory_order_seq_cst ) == position and
+				    impl::is_process_gone( owner ) ) {
+					// Only frees it if it was not taken again meanwhile
+					result |= cursor.m_owner.compare_exchange_strong(
+					  owner, 0, std::memory_order_seq_cst );
+				}
+			}
+			return result;
+		}
+
+		bool push( T const &value ) noexcept {
+			auto &r = ring( );
+			auto const next = r.m_published.load( std::memory_order_relaxed );
+			if( next - r.m_slowest_cache >= Capacity ) {
+				r.m_slowest_cache = slowest( r, next );
+				if( next - r.m_slowest_cache >= Capacity ) {
+					return false;
+				}
+			}
+			r.m_values[next % Capacity] = value;
+			r.m_published.store( next + 1, std::memory_order_seq_cst );
+			if( r.m_readers.m_waiters.load( std::memory_order_seq_cst ) > 0 ) {
+				impl::notify_all( r.m_readers );
+			}
+			return true;
+		}
+
+	public:
+		class subscriber {
+			daw::process::shared_memory<ring_t> m_ring{};
+			impl::broadcast_cursor_t *m_cursor = nullptr;
+			size_t m_position = 0;
+
+			friend class broadcast_channel;
+
+			subscriber( daw::process::shared_memory<ring_t> ring,
+			            impl::broadcast_cursor_t *cursor, size_t position ) noexcept
+			  : m_ring( std::move( ring ) )
+			  , m_cursor( cursor )
+			  , m_position( position ) {}
+
+			void cleanup( ) noexcept {
+				if( auto *cursor = std::exchange( m_cursor, nullptr ); cursor ) {
+					cursor->m_owner.store( 0, std::memory_order_seq_cst );
+					impl::notify( m_ring.data( )->m_writer );
+				}
+			}
+
+			std::optional<T> pop( ) noexcept {
+				auto &r = *m_ring.data( );
+				if( r.m_published.load( std::memory_order_seq_cst ) == m_position ) {
+					return std::nullopt;
+				}
+				T result = r.m_values[m_position % Capacity];
+				m_cursor->m_position.store( ++m_position, std::memory_order_seq_cst );
+				if( r.m_writer.m_waiters.load( std::memory_order_seq_cst ) > 0 ) {
+					impl::notify( r.m_writer );
+				}
+				return result;
+			}
+
+		public:
+			subscriber( subscriber const & ) = delete;
+			subscriber &operator=( subscriber const & ) = delete;
+
+			subscriber( subscriber &&other ) noexcept
+			  : m_ring( std::move( other.m_ring ) )
+			  , m_cursor( std::exchange( other.m_cursor, nullptr ) )
+			  , m_position( other.m_position ) {}
+
+			subscriber &operator=( subscriber &&rhs ) noexcept {
+				if( this != &rhs ) {
+					cleanup( );
+					m_ring = std::move( rhs.m_ring );
+					m_cursor = std::exchange( rhs.m_cursor, nullptr );
+					m_position = rhs.m_position;
+				}
+				return *this;
+			}
+
+			~subscriber( ) noexcept {
+				cleanup( );
+			}
+
+			T read( ) noexcept {
+				auto result = pop( );
+				if( !result ) {
+					impl::wait_until( m_ring.data( )->m_readers, [&] {
+						result = pop( );
+						return result.has_value( );
+					} );
+				}
+				return *result;
+			}
+
+			std::optional<T> try_read( ) noexcept {
+				return pop( );
+			}
+		};
+
+		broadcast_channel( ) noexcept = default;
+
+		explicit broadcast_channel( shared_memory_options const &opts ) noexcept
+		  : m_ring( opts ) {}
+
+		static constexpr size_t capacity( ) noexcept {
+			return Capacity;
+		}
+
+		static constexpr size_t max_subscribers( ) noexcept {
+			return MaxSubscribers;
+		}
+
+		// Claim a cursor, it is released when the subscriber is destroyed or by
+		// the writer after this process exits
+		subscriber subscribe( ) {
+			auto &r = ring( );
+			impl::broadcast_cursor_t *claimed = nullptr;
+			auto const self = getpid( );
+			for( auto &cursor : r.m_cursors ) {
+				::pid_t expected = 0;
+				if( cursor.m_owner.compare_exchange_strong(
+				      expected, self, std::memory_order_seq_cst ) ) {
+					claimed = &cursor;
+					break;
+				}
+			}
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  claimed == nullptr, "No free broadcast_channel subscriber" );
+			// Publish a position and then start from one read after the writer can
+			// see the cursor, values from there on cannot be overwritten
+			claimed->m_position.store(
+			  r.m_published.load( std::memory_order_seq_cst ),
+			  std::memory_order_seq_cst );
+			auto const position = r.m_published.load( std::memory_order_seq_cst );
+			claimed->m_position.store( position, std::memory_order_seq_cst );
+			// The writer may be waiting on the position a previous subscriber left
+			impl::notify( r.m_writer );
+			return subscriber( m_ring, claimed, position );
+		}
+
+		void write( T const &value ) noexcept {
+			auto const try_push = [&] { return push( value ); };
+			while( !impl::wait_until_for( ring( ).m_writer, try_push,
+			                              dead_check_interval ) ) {
+				(void)release_dead( );
+			}
+		}
+
+		bool try_write( T const &value ) noexcept {
+			return push( value ) or ( release_dead( ) and push( value ) );
+		}
+	};
+} // namespace daw::process
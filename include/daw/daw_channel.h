@@ -22,55 +22,266 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
 #include <optional>
+#include <string>
+#include <type_traits>
 
+#include <daw/daw_traits.h>
+
+#include "daw_await_fwd.h"
+#include "daw_metrics.h"
+#include "daw_pollable.h"
 #include "daw_semaphore.h"
 #include "daw_shared_memory.h"
 
 namespace daw::process {
-	template<typename T>
-	class channel {
+	namespace impl {
+		// The values of a channel fill a page, so that write_n/read_n can move
+		// many small values per synchronization
+		inline constexpr size_t channel_buffer_size = 4096;
+
+		template<typename T>
+		struct channel_batch_t {
+			static constexpr size_t capacity =
+			  std::max( size_t{1},
+			            ( channel_buffer_size - 2 * cache_line_size ) / sizeof( T ) );
+
+			// Values in the batch and the next one to read
+			size_t m_count;
+			size_t m_position;
+			std::array<T, capacity> m_values;
+		};
+	} // namespace impl
+
+	// A channel where a write waits for the previous batch of values to be read.
+	// write/read move one value, write_n/read_n move up to batch_capacity( )
+	// values per synchronization and both can be mixed freely.  With Poll set
+	// to pollable, poll_handle( ) becomes readable on writes
+	template<typename T, typename Metrics = no_metrics,
+	         typename Poll = not_pollable>
+	class channel : private Metrics, private Poll {
 		static_assert( std::is_trivially_copyable_v<T> );
 		static_assert( std::is_default_constructible_v<T> );
 
+		using batch_t = impl::channel_batch_t<T>;
+
 		daw::process::semaphore m_can_write{};
 		daw::process::semaphore m_can_read{};
-		daw::process::shared_memory<T> m_data{};
+		daw::process::shared_memory<batch_t> m_data{};
+
+		batch_t &batch( ) noexcept {
+			return *m_data.data( );
+		}
+
+		// Fill the batch, the writer must own it
+		size_t put( T const *values, size_t count ) noexcept {
+			auto &b = batch( );
+			auto const n = std::min( count, batch_t::capacity );
+			memcpy( b.m_values.data( ), values, n * sizeof( T ) );
+			b.m_count = n;
+			b.m_position = 0;
+			this->record_message( n * sizeof( T ) );
+			m_can_read.post( );
+			this->notify_poll_handle( );
+			return n;
+		}
+
+		// Take values from the batch, the reader must own it.  It is handed to
+		// the writers once empty, otherwise back to the readers
+		size_t take( T *values, size_t count ) noexcept {
+			auto &b = batch( );
+			auto const n = std::min( count, b.m_count - b.m_position );
+			memcpy( values, b.m_values.data( ) + b.m_position, n * sizeof( T ) );
+			b.m_position += n;
+			if( b.m_position < b.m_count ) {
+				m_can_read.post( );
+			} else {
+				m_can_write.post( );
+			}
+			return n;
+		}
+
+		template<typename Span>
+		static constexpr void check_span( ) noexcept {
+			using pointer_t =
+			  decltype( std::data( std::declval<daw::remove_cvref_t<Span> &>( ) ) );
+			static_assert(
+			  std::is_same_v<std::remove_cv_t<std::remove_pointer_t<pointer_t>>, T>,
+			  "Expected a contiguous range of T" );
+		}
 
 	public:
-		channel( ) noexcept {
+		channel( ) noexcept( std::is_nothrow_default_constructible_v<Poll> ) {
+			m_can_write.post( );
+		}
+
+		explicit channel( shared_memory_options const &opts ) noexcept(
+		  std::is_nothrow_default_constructible_v<Poll> )
+		  : m_data( opts ) {
 			m_can_write.post( );
 		}
 
+		// Attach to the channel called name so that unrelated processes can
+		// exchange values, it uses the objects name + ".can_write", ".can_read",
+		// ".data" and ".metrics"
+		channel( open_or_create_t, std::string const &name,
+		         shared_memory_options const &opts = {} )
+		  : Metrics( open_or_create, name + ".metrics" )
+		  , m_can_write( open_or_create, name + ".can_write", 1 )
+		  , m_can_read( open_or_create, name + ".can_read" )
+		  , m_data( open_or_create, name + ".data", impl::no_init{}, opts ) {
+			static_assert( not Poll::is_enabled,
+			               "A pollable fd cannot be attached by name" );
+		}
+
+		static bool remove( std::string const &name ) noexcept {
+			auto result = semaphore::remove( name + ".can_write" );
+			result &= semaphore::remove( name + ".can_read" );
+			result &= shared_memory<batch_t>::remove( name + ".data" );
+			result &= Metrics::remove( name + ".metrics" );
+			return result;
+		}
+
+		// True when a read would not wait
+		bool is_readable( ) noexcept {
+			return m_can_read.value( ) > 0;
+		}
+
+		// The pollable fd, or -1 when Poll is not_pollable
+		int poll_handle( ) const noexcept {
+			return Poll::poll_handle( );
+		}
+
+		void drain_poll_handle( ) noexcept {
+			Poll::drain_poll_handle( );
+		}
+
+		static constexpr size_t batch_capacity( ) noexcept {
+			return batch_t::capacity;
+		}
+
 		void write( T const &value ) noexcept {
-			m_can_write.wait( );
-			m_data.write( value );
-			m_can_read.post( );
+			impl::metered_wait<Metrics>( *this, metrics_side::write,
+			                             m_can_write );
+			(void)put( &value, 1 );
 		}
 
 		bool try_write( T const &value ) noexcept {
-			if( m_can_write.try_wait( ) ) {
-				m_data.write( value );
-				m_can_read.post( );
-				return true;
-			}
-			return false;
+			return try_write_n( &value, 1 ) == 1;
 		}
 
 		T read( ) noexcept {
-			m_can_read.wait( );
-			auto result = m_data.read( );
-			m_can_write.post( );
+			impl::metered_wait<Metrics>( *this, metrics_side::read,
+			                             m_can_read );
+			T result;
+			(void)take( &result, 1 );
 			return result;
 		}
 
 		std::optional<T> try_read( ) noexcept {
-			if( m_can_read.try_wait( ) ) {
-				auto result = m_data.read( );
-				m_can_write.post( );
+			T result;
+			if( try_read_n( &result, 1 ) == 1 ) {
 				return result;
 			}
 			return std::nullopt;
 		}
+
+		// Write all count values, in batches of up to batch_capacity( )
+		void write_n( T const *values, size_t count ) noexcept {
+			while( count > 0 ) {
+				impl::metered_wait<Metrics>( *this, metrics_side::write,
+				                             m_can_write );
+				auto const n = put( values, count );
+				values += n;
+				count -= n;
+			}
+		}
+
+		template<typename Span>
+		void write_n( Span const &values ) noexcept {
+			check_span<Span>( );
+			write_n( std::data( values ), std::size( values ) );
+		}
+
+		// Write one batch of up to batch_capacity( ) values if the channel is
+		// free.  Returns the number of values written
+		size_t try_write_n( T const *values, size_t count ) noexcept {
+			if( count == 0 or !m_can_write.try_wait( ) ) {
+				return 0;
+			}
+			this->record_acquired( metrics_side::write );
+			return put( values, count );
+		}
+
+		template<typename Span>
+		size_t try_write_n( Span const &values ) noexcept {
+			check_span<Span>( );
+			return try_write_n( std::data( values ), std::size( values ) );
+		}
+
+		// Read exactly count values, waiting for more batches as needed
+		void read_n( T *values, size_t count ) noexcept {
+			while( count > 0 ) {
+				impl::metered_wait<Metrics>( *this, metrics_side::read,
+				                             m_can_read );
+				auto const n = take( values, count );
+				values += n;
+				count -= n;
+			}
+		}
+
+		template<typename Span>
+		void read_n( Span &&values ) noexcept {
+			check_span<Span>( );
+			read_n( std::data( values ), std::size( values ) );
+		}
+
+		// Read up to count of the values that are ready without waiting.
+		// Returns the number of values read
+		size_t try_read_n( T *values, size_t count ) noexcept {
+			if( count == 0 or !m_can_read.try_wait( ) ) {
+				return 0;
+			}
+			this->record_acquired( metrics_side::read );
+			return take( values, count );
+		}
+
+		template<typename Span>
+		size_t try_read_n( Span &&values ) noexcept {
+			check_span<Span>( );
+			return try_read_n( std::data( values ), std::size( values ) );
+		}
+
+#if defined( DAW_PROCESS_HAS_COROUTINES )
+		// co_await chan.async_read( ) gives the next value without blocking the
+		// thread, the coroutine is resumed through executor.  The default,
+		// inline_executor, resumes it on a service thread of the library and not
+		// on the thread that awaited.  Needs daw_await.h
+		template<typename Executor = inline_executor>
+		auto async_read( Executor executor = Executor{} ) {
+			auto *st = m_can_read.native_handle( );
+			return semaphore_awaitable( &st->m_count, &st->m_waiters,
+			                            [this] { return try_read( ); },
+			                            std::move( executor ) );
+		}
+
+		template<typename Executor = inline_executor>
+		auto async_write( T const &value, Executor executor = Executor{} ) {
+			auto *st = m_can_write.native_handle( );
+			return semaphore_awaitable( &st->m_count, &st->m_waiters,
+			                            [this, value] { return try_write( value ); },
+			                            std::move( executor ) );
+		}
+#endif
+
+		// Counters of this channel, all zero unless Metrics is shared_metrics
+		metrics_snapshot metrics( ) const noexcept {
+			return Metrics::snapshot( );
+		}
 	};
 } // namespace daw::process
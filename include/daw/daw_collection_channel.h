@@ -23,22 +23,74 @@
 #pragma once
 
 #include <algorithm>
-#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <memory>
-#include <optional>
+#include <new>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
-#include "daw_channel.h"
+#include <daw/daw_exception.h>
+#include <daw/daw_traits.h>
+
+#include "daw_metrics.h"
+#include "daw_semaphore.h"
+#include "daw_shared_memory.h"
 
 namespace daw::process {
 	namespace impl {
-		template<typename T, size_t Size>
-		struct buffer_t {
-			std::array<T, Size> m_values = {};
-			size_t m_value_count = 0;
+		// Each message is prefixed with the number of values in the whole
+		// collection and the number in this message.  When the writer cannot
+		// know the size up front, the total is one more than has been sent until
+		// the last message
+		struct collection_header_t {
+			uint64_t m_total;
+			uint64_t m_count;
 		};
+		static_assert( sizeof( collection_header_t ) <= cache_line_size );
+
+		// Collections whose data( ) is a pointer to T can be sent with memcpy
+		template<typename Collection, typename T, typename = void>
+		struct is_contiguous_collection : std::false_type {};
+
+		template<typename Collection, typename T>
+		struct is_contiguous_collection<
+		  Collection, T,
+		  std::void_t<decltype( std::data( std::declval<Collection &>( ) ) ),
+		              decltype( std::size( std::declval<Collection &>( ) ) )>>
+		  : std::is_same<std::remove_cv_t<std::remove_pointer_t<decltype(
+		                   std::data( std::declval<Collection &>( ) ) )>>,
+		                 T> {};
+
+		template<typename Collection, typename = void>
+		struct has_size : std::false_type {};
+
+		template<typename Collection>
+		struct has_size<Collection, std::void_t<decltype( std::size(
+		                              std::declval<Collection &>( ) ) )>>
+		  : std::true_type {};
+
+		template<typename Collection, typename = void>
+		struct has_reserve : std::false_type {};
+
+		template<typename Collection>
+		struct has_reserve<
+		  Collection, std::void_t<decltype( std::declval<Collection &>( ).reserve(
+		                std::declval<size_t>( ) ) )>> : std::true_type {};
+
+		template<typename Collection, typename T, typename = void>
+		struct has_range_insert : std::false_type {};
+
+		template<typename Collection, typename T>
+		struct has_range_insert<
+		  Collection, T,
+		  std::void_t<decltype( std::declval<Collection &>( ).insert(
+		    std::declval<Collection &>( ).end( ), std::declval<T const *>( ),
+		    std::declval<T const *>( ) ) )>> : std::true_type {};
 	} // namespace impl
 
 	struct push_back_appender {
@@ -48,45 +100,191 @@ namespace daw::process {
 		}
 	};
 
-	template<typename T, size_t max_items_per_message = 10>
-	class collection_channel {
-		using buffer_t = impl::buffer_t<T, max_items_per_message>;
-		daw::process::channel<std::optional<buffer_t>> m_channel{};
+	// Sends collections of trivially copyable values through a shared buffer
+	// that holds up to items_per_message values at a time.  Contiguous
+	// collections are copied with memcpy and the reader reserves room for the
+	// whole collection from the first message
+	template<typename T, size_t max_items_per_message = 10,
+	         typename Metrics = no_metrics>
+	class collection_channel : private Metrics {
+		static_assert( std::is_trivially_copyable_v<T> );
+		static_assert( alignof( T ) <= impl::cache_line_size );
+		static_assert( max_items_per_message > 0 );
+
+		daw::process::semaphore m_can_write{};
+		daw::process::semaphore m_can_read{};
+		impl::shared_region m_buffer;
+		size_t m_items_per_message;
+
+		impl::collection_header_t &header( ) noexcept {
+			return *std::launder(
+			  reinterpret_cast<impl::collection_header_t *>( m_buffer.data( ) ) );
+		}
+
+		T *values( ) noexcept {
+			return std::launder( reinterpret_cast<T *>(
+			  static_cast<char *>( m_buffer.data( ) ) + impl::cache_line_size ) );
+		}
+
+		template<typename Iterator>
+		void send( Iterator first, size_t total ) {
+			auto remaining = total;
+			do {
+				auto const count = std::min( remaining, m_items_per_message );
+				impl::metered_wait<Metrics>( *this, metrics_side::write,
+				                             m_can_write );
+				header( ) = {total, count};
+				if constexpr( std::is_pointer_v<Iterator> ) {
+					if( count > 0 ) {
+						memcpy( values( ), first, count * sizeof( T ) );
+					}
+					first += count;
+				} else {
+					auto out = values( );
+					for( size_t n = 0; n < count; ++n, ++first ) {
+						out[n] = *first;
+					}
+				}
+				this->record_message( count * sizeof( T ) );
+				m_can_read.post( );
+				remaining -= count;
+			} while( remaining > 0 );
+		}
+
+		// Send [first, last) in one pass for collections without a size
+		template<typename Iterator, typename Sentinel>
+		void send_unsized( Iterator first, Sentinel last ) {
+			size_t sent = 0;
+			do {
+				impl::metered_wait<Metrics>( *this, metrics_side::write,
+				                             m_can_write );
+				auto out = values( );
+				size_t count = 0;
+				for( ; count < m_items_per_message and first != last;
+				     ++count, ++first ) {
+					out[count] = *first;
+				}
+				sent += count;
+				auto const total = first == last ? sent : sent + 1;
+				header( ) = {total, count};
+				this->record_message( count * sizeof( T ) );
+				m_can_read.post( );
+			} while( first != last );
+		}
 
 	public:
-		collection_channel( ) noexcept = default;
+		collection_channel( )
+		  : collection_channel( max_items_per_message ) {}
+
+		// e.g. a items_per_message of 64KiB / sizeof( T ) lets large collections
+		// move at close to memcpy speed
+		explicit collection_channel( size_t items_per_message,
+		                             shared_memory_options const &opts = {} )
+		  : m_buffer( impl::cache_line_size +
+		                std::max( items_per_message, size_t{1} ) * sizeof( T ),
+		              opts )
+		  , m_items_per_message( std::max( items_per_message, size_t{1} ) ) {
+
+			daw::exception::daw_throw_on_false<std::runtime_error>(
+			  m_buffer.data( ), "Error mapping collection_channel buffer" );
+			m_can_write.post( );
+		}
+
+		size_t items_per_message( ) const noexcept {
+			return m_items_per_message;
+		}
+
+		// Wait for the buffer and lease room for count values in it.  The values
+		// are sent, as one collection, by commit
+		buffer_span<T> acquire_write( size_t count ) {
+			daw::exception::daw_throw_on_true<std::out_of_range>(
+			  count > m_items_per_message, "Lease is larger than a message" );
+			impl::metered_wait<Metrics>( *this, metrics_side::write,
+			                             m_can_write );
+			header( ) = {count, count};
+			return {values( ), count};
+		}
+
+		void commit( ) noexcept {
+			this->record_message(
+			  static_cast<size_t>( header( ).m_count ) * sizeof( T ) );
+			m_can_read.post( );
+		}
+
+		// Send only the first count values of the lease.  Throws, keeping the
+		// lease, when count is larger than it
+		void commit( size_t count ) {
+			daw::exception::daw_throw_on_true<std::out_of_range>(
+			  count > header( ).m_count, "Commit is larger than the lease" );
+			header( ) = {count, count};
+			this->record_message( count * sizeof( T ) );
+			m_can_read.post( );
+		}
+
+		// Wait for the next message and view it in place.  A collection larger
+		// than items_per_message is seen one message at a time.  The buffer is
+		// not reused until release is called
+		buffer_span<T const> acquire_read( ) {
+			impl::metered_wait<Metrics>( *this, metrics_side::read,
+			                             m_can_read );
+			return {values( ), static_cast<size_t>( header( ).m_count )};
+		}
+
+		void release( ) noexcept {
+			m_can_write.post( );
+		}
 
 		template<typename Collection>
 		inline void write( Collection &&collection ) {
 			static_assert(
 			  !std::is_same_v<collection_channel, daw::remove_cvref_t<Collection>> );
-			auto first = std::begin( collection );
-			auto last = std::end( collection );
-			while( first != last ) {
-				buffer_t buff = {};
-				for( ; buff.m_value_count < max_items_per_message and first != last;
-				     ++buff.m_value_count, ++first ) {
-
-					buff.m_values[buff.m_value_count] = *first;
-				}
-				if( buff.m_value_count > 0 ) {
-					m_channel.write( buff );
-				}
+			if constexpr( impl::is_contiguous_collection<
+			                daw::remove_cvref_t<Collection>, T>::value ) {
+				T const *first = std::data( collection );
+				send( first, static_cast<size_t>( std::size( collection ) ) );
+			} else if constexpr( impl::has_size<
+			                       daw::remove_cvref_t<Collection>>::value ) {
+				send( std::begin( collection ),
+				      static_cast<size_t>( std::size( collection ) ) );
+			} else {
+				send_unsized( std::begin( collection ), std::end( collection ) );
 			}
-			m_channel.write( std::nullopt );
 		}
 
 		template<typename Result = std::vector<T>,
 		         typename Appender = push_back_appender>
 		inline Result read( ) {
 			auto result = Result{};
-			auto msg = m_channel.read( );
 			auto it_out = Appender{}( result );
-			while( msg ) {
-				std::copy_n( msg->m_values.begin( ), msg->m_value_count, it_out );
-				msg = m_channel.read( );
-			}
+			size_t received = 0;
+			size_t total = 0;
+			do {
+				impl::metered_wait<Metrics>( *this, metrics_side::read,
+				                             m_can_read );
+				auto const hdr = header( );
+				total = static_cast<size_t>( hdr.m_total );
+				if( received == 0 ) {
+					if constexpr( impl::has_reserve<Result>::value ) {
+						result.reserve( total );
+					}
+				}
+				T const *first = values( );
+				auto const count = static_cast<size_t>( hdr.m_count );
+				if constexpr( std::is_same_v<Appender, push_back_appender> and
+				              impl::has_range_insert<Result, T>::value ) {
+					result.insert( result.end( ), first, first + count );
+				} else {
+					it_out = std::copy_n( first, count, it_out );
+				}
+				m_can_write.post( );
+				received += count;
+			} while( received < total );
 			return result;
 		}
+
+		// Counters of this channel, all zero unless Metrics is shared_metrics
+		metrics_snapshot metrics( ) const noexcept {
+			return Metrics::snapshot( );
+		}
 	};
 } // namespace daw::process
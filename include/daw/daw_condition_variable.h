@@ -0,0 +1,129 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <utility>
+
+#include "daw_futex.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	// A condition variable in anonymous shared memory for use with
+	// shared_mutex, or any lock, across processes.  notify_all is one futex
+	// wake of every waiter and neither notify enters the kernel when no one is
+	// waiting
+	class condition_variable {
+		daw::process::shared_memory<impl::waiters_t> m_waiters{};
+
+		impl::waiters_t &waiters( ) noexcept {
+			return *m_waiters.data( );
+		}
+
+	public:
+		condition_variable( ) noexcept = default;
+
+		void notify_one( ) noexcept {
+			impl::notify( waiters( ), 1 );
+		}
+
+		void notify_all( ) noexcept {
+			impl::notify_all( waiters( ) );
+		}
+
+		// lck must be locked, it is unlocked while waiting
+		template<typename Lock>
+		void wait( Lock &lck ) {
+			auto &w = waiters( );
+			// Registered before unlocking so that a notify after the unlock
+			// changes the epoch we wait on
+			w.m_waiters.fetch_add( 1, std::memory_order_seq_cst );
+			auto const epoch = w.m_epoch.load( std::memory_order_seq_cst );
+			lck.unlock( );
+			impl::futex_wait( &w.m_epoch, epoch );
+			w.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+			lck.lock( );
+		}
+
+		template<typename Lock, typename Predicate>
+		void wait( Lock &lck, Predicate pred ) {
+			while( !pred( ) ) {
+				wait( lck );
+			}
+		}
+
+		template<typename Lock, typename Clock, typename Duration>
+		std::cv_status
+		wait_until( Lock &lck,
+		            std::chrono::time_point<Clock, Duration> const &abs_time ) {
+			auto &w = waiters( );
+			w.m_waiters.fetch_add( 1, std::memory_order_seq_cst );
+			auto const epoch = w.m_epoch.load( std::memory_order_seq_cst );
+			lck.unlock( );
+			auto const left = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			  abs_time - Clock::now( ) );
+			auto is_woken = false;
+			if( left.count( ) > 0 ) {
+				auto const timeout =
+				  timespec{static_cast<time_t>( left.count( ) / 1'000'000'000 ),
+				           static_cast<long>( left.count( ) % 1'000'000'000 )};
+				is_woken = impl::futex_wait_for( &w.m_epoch, epoch, timeout );
+			}
+			w.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+			lck.lock( );
+			return is_woken or Clock::now( ) < abs_time ? std::cv_status::no_timeout
+			                                           : std::cv_status::timeout;
+		}
+
+		template<typename Lock, typename Clock, typename Duration,
+		         typename Predicate>
+		bool wait_until( Lock &lck,
+		                 std::chrono::time_point<Clock, Duration> const &abs_time,
+		                 Predicate pred ) {
+			while( !pred( ) ) {
+				if( wait_until( lck, abs_time ) == std::cv_status::timeout ) {
+					return pred( );
+				}
+			}
+			return true;
+		}
+
+		template<typename Lock, typename Rep, typename Period>
+		std::cv_status
+		wait_for( Lock &lck, std::chrono::duration<Rep, Period> const &rel_time ) {
+			return wait_until( lck, std::chrono::steady_clock::now( ) + rel_time );
+		}
+
+		template<typename Lock, typename Rep, typename Period, typename Predicate>
+		bool wait_for( Lock &lck,
+		               std::chrono::duration<Rep, Period> const &rel_time,
+		               Predicate pred ) {
+			return wait_until( lck, std::chrono::steady_clock::now( ) + rel_time,
+			                   std::move( pred ) );
+		}
+	};
+} // namespace daw::process
@@ -0,0 +1,170 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+
+#if defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace daw::process::impl {
+	static_assert( sizeof( std::atomic<uint32_t> ) == sizeof( uint32_t ) );
+	static_assert( std::atomic<uint32_t>::is_always_lock_free );
+
+	inline void cpu_relax( ) noexcept {
+#if defined( __x86_64__ ) or defined( __i386__ )
+		__builtin_ia32_pause( );
+#elif defined( __aarch64__ ) or defined( __arm__ )
+		asm volatile( "yield" ::: "memory" );
+#endif
+	}
+
+#if defined( __linux__ )
+	// The futexes are not FUTEX_PRIVATE as they live in memory mapped into
+	// several processes
+	inline void futex_wait( std::atomic<uint32_t> *addr,
+	                        uint32_t expected ) noexcept {
+		(void)syscall( SYS_futex, reinterpret_cast<uint32_t *>( addr ), FUTEX_WAIT,
+		               expected, nullptr, nullptr, 0 );
+	}
+
+	// Returns false when timeout passed before a wake up
+	inline bool futex_wait_for( std::atomic<uint32_t> *addr, uint32_t expected,
+	                            timespec const &timeout ) noexcept {
+		auto const result =
+		  syscall( SYS_futex, reinterpret_cast<uint32_t *>( addr ), FUTEX_WAIT,
+		           expected, &timeout, nullptr, 0 );
+		return not( result < 0 and errno == ETIMEDOUT );
+	}
+
+	inline void futex_wake( std::atomic<uint32_t> *addr,
+	                        uint32_t count ) noexcept {
+		(void)syscall( SYS_futex, reinterpret_cast<uint32_t *>( addr ), FUTEX_WAKE,
+		               count, nullptr, nullptr, 0 );
+	}
+#else
+	// No portable process shared futex, park for a short time and let the
+	// caller check again
+	inline void futex_wait( std::atomic<uint32_t> *addr,
+	                        uint32_t expected ) noexcept {
+		if( addr->load( std::memory_order_acquire ) == expected ) {
+			auto const ts = timespec{0, 50'000};
+			nanosleep( &ts, nullptr );
+		}
+	}
+
+	inline bool futex_wait_for( std::atomic<uint32_t> *addr, uint32_t expected,
+	                            timespec const &timeout ) noexcept {
+		if( timeout.tv_sec == 0 and timeout.tv_nsec < 50'000 ) {
+			nanosleep( &timeout, nullptr );
+			return false;
+		}
+		futex_wait( addr, expected );
+		return true;
+	}
+
+	inline void futex_wake( std::atomic<uint32_t> *, uint32_t ) noexcept {}
+#endif
+
+	inline void futex_wake_all( std::atomic<uint32_t> *addr ) noexcept {
+		futex_wake( addr,
+		            static_cast<uint32_t>( std::numeric_limits<int>::max( ) ) );
+	}
+
+	// Number of times to retry with cpu_relax before parking on a futex
+	inline constexpr size_t spin_count = 128;
+
+	// Sleepers record the epoch, check their condition and then wait for the
+	// epoch to change.  Notifiers bump the epoch and only wake when someone is
+	// asleep
+	struct waiters_t {
+		std::atomic<uint32_t> m_epoch;
+		std::atomic<uint32_t> m_waiters;
+	};
+
+	inline void notify( waiters_t &w, uint32_t count = 1 ) noexcept {
+		w.m_epoch.fetch_add( 1, std::memory_order_seq_cst );
+		if( w.m_waiters.load( std::memory_order_seq_cst ) > 0 ) {
+			futex_wake( &w.m_epoch, count );
+		}
+	}
+
+	inline void notify_all( waiters_t &w ) noexcept {
+		notify( w, static_cast<uint32_t>( std::numeric_limits<int>::max( ) ) );
+	}
+
+	// Spin briefly and then sleep until pred( ) is true
+	template<typename Predicate>
+	void wait_until( waiters_t &w, Predicate pred ) {
+		for( size_t n = 0; n < spin_count; ++n ) {
+			if( pred( ) ) {
+				return;
+			}
+			cpu_relax( );
+		}
+		while( true ) {
+			w.m_waiters.fetch_add( 1, std::memory_order_seq_cst );
+			auto const epoch = w.m_epoch.load( std::memory_order_seq_cst );
+			if( pred( ) ) {
+				w.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+				return;
+			}
+			futex_wait( &w.m_epoch, epoch );
+			w.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+		}
+	}
+
+	// Like wait_until but gives up after about timeout without a notify.
+	// Returns whether pred( ) became true
+	template<typename Predicate>
+	bool wait_until_for( waiters_t &w, Predicate pred,
+	                     timespec const &timeout ) {
+		for( size_t n = 0; n < spin_count; ++n ) {
+			if( pred( ) ) {
+				return true;
+			}
+			cpu_relax( );
+		}
+		while( true ) {
+			w.m_waiters.fetch_add( 1, std::memory_order_seq_cst );
+			auto const epoch = w.m_epoch.load( std::memory_order_seq_cst );
+			if( pred( ) ) {
+				w.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+				return true;
+			}
+			auto const is_woken = futex_wait_for( &w.m_epoch, epoch, timeout );
+			w.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+			if( !is_woken ) {
+				return pred( );
+			}
+		}
+	}
+} // namespace daw::process::impl
@@ -23,41 +23,275 @@
 #pragma once
 
 #include <cstddef>
+#include <exception>
 #include <functional>
 #include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <sys/wait.h>
 #include <type_traits>
 #include <unistd.h>
 
-#include <daw/daw_exception.h>
-
+#include "daw_await.h"
 #include "daw_channel.h"
+#include "daw_memfd_buffer.h"
 #include "daw_process.h"
+#include "daw_process_reaper.h"
 
 namespace daw::process {
-	template<typename Function, typename... Arguments,
-	         typename Ret = std::remove_cv_t<std::remove_reference_t<
-	           std::invoke_result_t<Function, Arguments...>>>>
-	std::future<Ret> async( Function &&func, Arguments &&... arguments ) {
+	namespace impl {
+		// Containers like std::vector<double> or std::string whose elements can
+		// be sent through a memfd_buffer
+		template<typename T, typename = void>
+		struct is_contiguous_result : std::false_type {};
+
+		template<typename T>
+		struct is_contiguous_result<
+		  T, std::void_t<typename T::value_type,
+		                 decltype( std::data( std::declval<T const &>( ) ) ),
+		                 decltype( std::size( std::declval<T const &>( ) ) )>>
+		  : std::bool_constant<
+		      not std::is_trivially_copyable_v<T> and
+		      std::is_trivially_copyable_v<typename T::value_type> and
+		      std::is_constructible_v<T, typename T::value_type const *,
+		                              typename T::value_type const *>> {};
 
-		return std::async(
-		  std::launch::async,
-		  []( auto &&f, auto &&... args ) -> Ret {
-			  // Child
-			  auto mem = daw::process::shared_memory<Ret>( );
-			  auto sem = daw::process::semaphore( );
-			  auto proc = daw::process::fork_process( [&]( ) {
-				  mem.write( std::invoke( *std::forward<Function>( f ),
-				                          std::forward<Arguments>( args )... ) );
+		template<typename T>
+		inline constexpr bool is_contiguous_result_v =
+		  is_contiguous_result<T>::value;
+
+		// Fork a child that runs store( resource ).  Once it has exited
+		// successfully, result is given the value of load( resource ).  The
+		// child is waited on by the reaper instead of a thread per call.  Promise
+		// is std::promise or anything with set_value and set_exception
+		template<typename SpawnPolicy = fork_spawn, typename Resource,
+		         typename Store, typename Load, typename Promise>
+		void async_with( launch_options const &opts, Resource resource,
+		                 Store store, Load load, Promise result ) {
+			// The callable runs in the parent's memory with a vfork, where writing
+			// the result and unwinding on a throw are not safe
+			static_assert( not std::is_same_v<SpawnPolicy, vfork_spawn>,
+			               "vfork_spawn is only for fork_process children that "
+			               "exec" );
+			auto sem = daw::process::semaphore( );
+			auto proc =
+			  daw::process::fork_process<false, SpawnPolicy>( opts, [&]( ) {
+				  // Child
+				  store( resource );
 				  sem.post( );
 			  } );
 
-			  // Parent
-			  proc.join( );
-			  daw::exception::daw_throw_on_false<std::runtime_error>(
-			    sem.try_wait( ), "Error running callable" );
-			  return mem.read( );
+			// Parent
+			daw::process::process_reaper::get( ).watch(
+			  proc.native_handle( ),
+			  [resource = std::move( resource ), sem = std::move( sem ),
+			   load = std::move( load ),
+			   result = std::move( result )]( int ) mutable {
+				  if( sem.try_wait( ) ) {
+					  result.set_value( load( resource ) );
+				  } else {
+					  result.set_exception( std::make_exception_ptr(
+					    std::runtime_error( "Error running callable" ) ) );
+				  }
+			  } );
+		}
+
+		// Run func( arguments... ) in a child and give its result to result
+		template<typename Ret, typename SpawnPolicy = fork_spawn,
+		         typename Promise, typename Function, typename... Arguments>
+		void async_to( launch_options const &opts, Promise result,
+		               Function &&func, Arguments &&... arguments ) {
+			if constexpr( impl::is_contiguous_result_v<Ret> ) {
+				impl::async_with<SpawnPolicy>(
+				  opts, daw::process::memfd_buffer( ),
+				  [&]( daw::process::memfd_buffer &buff ) {
+					  auto const value =
+					    std::invoke( std::forward<Function>( func ),
+					                 std::forward<Arguments>( arguments )... );
+					  buff.assign( std::data( value ), std::size( value ) );
+				  },
+				  []( daw::process::memfd_buffer &buff ) {
+					  return buff.template read<Ret>( );
+				  },
+				  std::move( result ) );
+			} else {
+				impl::async_with<SpawnPolicy>(
+				  opts, daw::process::shared_memory<Ret>( ),
+				  [&]( daw::process::shared_memory<Ret> &mem ) {
+					  mem.write( std::invoke( std::forward<Function>( func ),
+					                          std::forward<Arguments>( arguments )... ) );
+				  },
+				  []( daw::process::shared_memory<Ret> &mem ) { return mem.read( ); },
+				  std::move( result ) );
+			}
+		}
+	} // namespace impl
+
+	// Run func( arguments... ) in a child process.  Ret must either be
+	// trivially copyable or a contiguous container of trivially copyable values,
+	// e.g. std::vector<double> or std::string.  The latter are written to a
+	// memfd_buffer that grows to fit them.  SpawnPolicy picks how the child is
+	// created, but cannot be vfork_spawn.  opts is applied in the child before
+	// func runs
+	template<typename SpawnPolicy = fork_spawn, typename Function,
+	         typename... Arguments,
+	         typename Ret = std::remove_cv_t<std::remove_reference_t<
+	           std::invoke_result_t<Function, Arguments...>>>>
+	std::future<Ret> async( launch_options const &opts, Function &&func,
+	                        Arguments &&... arguments ) {
+		auto result = std::promise<Ret>( );
+		auto fut = result.get_future( );
+		impl::async_to<Ret, SpawnPolicy>( opts, std::move( result ),
+		                                  std::forward<Function>( func ),
+		                                  std::forward<Arguments>( arguments )... );
+		return fut;
+	}
+
+	template<typename SpawnPolicy = fork_spawn, typename Function,
+	         typename... Arguments,
+	         typename Ret = std::remove_cv_t<std::remove_reference_t<
+	           std::invoke_result_t<Function, Arguments...>>>>
+	std::future<Ret> async( Function &&func, Arguments &&... arguments ) {
+		return async<SpawnPolicy>( launch_options{}, std::forward<Function>( func ),
+		                           std::forward<Arguments>( arguments )... );
+	}
+
+	// Like async, but the parent gets a read only mapping of the container the
+	// child returned instead of a copy of it
+	template<typename SpawnPolicy = fork_spawn, typename Function,
+	         typename... Arguments,
+	         typename Ret = std::remove_cv_t<std::remove_reference_t<
+	           std::invoke_result_t<Function, Arguments...>>>,
+	         typename T = typename Ret::value_type>
+	std::future<mapped_view<T>> async_view( Function &&func,
+	                                        Arguments &&... arguments ) {
+		static_assert( impl::is_contiguous_result_v<Ret> );
+		auto result = std::promise<mapped_view<T>>( );
+		auto fut = result.get_future( );
+		impl::async_with<SpawnPolicy>(
+		  launch_options{}, daw::process::memfd_buffer( ),
+		  [&]( daw::process::memfd_buffer &buff ) {
+			  auto const value =
+			    std::invoke( std::forward<Function>( func ),
+			                 std::forward<Arguments>( arguments )... );
+			  buff.assign( std::data( value ), std::size( value ) );
 		  },
+		  []( daw::process::memfd_buffer &buff ) {
+			  return buff.template view<T>( );
+		  },
+		  std::move( result ) );
+		return fut;
+	}
+
+#if defined( DAW_PROCESS_HAS_COROUTINES )
+	namespace impl {
+		template<typename T>
+		struct task_state {
+			std::mutex m_mutex{};
+			std::optional<T> m_value{};
+			std::exception_ptr m_exception{};
+			bool m_is_done = false;
+			std::coroutine_handle<> m_waiter{};
+			std::function<void( std::coroutine_handle<> )> m_executor =
+			  inline_executor{};
+
+			void finish( ) {
+				auto waiter = std::coroutine_handle<>( );
+				auto executor = std::function<void( std::coroutine_handle<> )>( );
+				{
+					auto const lck = std::lock_guard( m_mutex );
+					m_is_done = true;
+					waiter = std::exchange( m_waiter, nullptr );
+					executor = m_executor;
+				}
+				if( waiter ) {
+					executor( waiter );
+				}
+			}
+		};
+
+		// Completes a process_task from the reaper's thread
+		template<typename T>
+		struct task_promise {
+			std::shared_ptr<task_state<T>> m_state;
+
+			void set_value( T value ) {
+				m_state->m_value = std::move( value );
+				m_state->finish( );
+			}
+
+			void set_exception( std::exception_ptr ex ) {
+				m_state->m_exception = std::move( ex );
+				m_state->finish( );
+			}
+		};
+	} // namespace impl
+
+	// The result of a child process that can be co_await'ed.  The coroutine is
+	// resumed through the executor given to resume_on once the child exits,
+	// the default resumes it on the reaper's thread
+	template<typename T>
+	class [[nodiscard]] process_task {
+		std::shared_ptr<impl::task_state<T>> m_state;
+
+	public:
+		explicit process_task( std::shared_ptr<impl::task_state<T>> state )
+		  : m_state( std::move( state ) ) {}
+
+		template<typename Executor>
+		process_task &resume_on( Executor executor ) & {
+			auto const lck = std::lock_guard( m_state->m_mutex );
+			m_state->m_executor = std::move( executor );
+			return *this;
+		}
+
+		template<typename Executor>
+		process_task &&resume_on( Executor executor ) && {
+			return std::move( resume_on( std::move( executor ) ) );
+		}
+
+		bool is_ready( ) const {
+			auto const lck = std::lock_guard( m_state->m_mutex );
+			return m_state->m_is_done;
+		}
+
+		bool await_ready( ) const {
+			return is_ready( );
+		}
+
+		bool await_suspend( std::coroutine_handle<> handle ) {
+			auto const lck = std::lock_guard( m_state->m_mutex );
+			if( m_state->m_is_done ) {
+				return false;
+			}
+			m_state->m_waiter = handle;
+			return true;
+		}
+
+		T await_resume( ) {
+			if( m_state->m_exception ) {
+				std::rethrow_exception( m_state->m_exception );
+			}
+			return std::move( *m_state->m_value );
+		}
+	};
+
+	// Like async, but the result is awaited with co_await instead of a future.
+	// Unless resume_on is given an executor, the coroutine is resumed on the
+	// process_reaper's thread and not on the thread that awaited
+	template<typename SpawnPolicy = fork_spawn, typename Function,
+	         typename... Arguments,
+	         typename Ret = std::remove_cv_t<std::remove_reference_t<
+	           std::invoke_result_t<Function, Arguments...>>>>
+	process_task<Ret> async_task( Function &&func, Arguments &&... arguments ) {
+		auto state = std::make_shared<impl::task_state<Ret>>( );
+		impl::async_to<Ret, SpawnPolicy>(
+		  launch_options{}, impl::task_promise<Ret>{state},
 		  std::forward<Function>( func ), std::forward<Arguments>( arguments )... );
+		return process_task<Ret>( std::move( state ) );
 	}
+#endif
 } // namespace daw::process
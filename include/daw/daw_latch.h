@@ -0,0 +1,78 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "daw_futex.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		struct latch_state {
+			std::atomic<uint32_t> m_count;
+			waiters_t m_done;
+		};
+	} // namespace impl
+
+	// A single use count down in anonymous shared memory.  Waiters are woken
+	// by one futex wake when the count reaches zero, earlier count downs never
+	// enter the kernel
+	class latch {
+		daw::process::shared_memory<impl::latch_state> m_state{};
+
+		impl::latch_state &state( ) noexcept {
+			return *m_state.data( );
+		}
+
+	public:
+		explicit latch( std::ptrdiff_t expected ) noexcept {
+			state( ).m_count.store( static_cast<uint32_t>( expected ),
+			                        std::memory_order_release );
+		}
+
+		void count_down( std::ptrdiff_t n = 1 ) noexcept {
+			auto &st = state( );
+			auto const update = static_cast<uint32_t>( n );
+			if( st.m_count.fetch_sub( update, std::memory_order_acq_rel ) ==
+			    update ) {
+				impl::notify_all( st.m_done );
+			}
+		}
+
+		bool try_wait( ) noexcept {
+			return state( ).m_count.load( std::memory_order_acquire ) == 0;
+		}
+
+		void wait( ) noexcept {
+			impl::wait_until( state( ).m_done, [&] { return try_wait( ); } );
+		}
+
+		void arrive_and_wait( std::ptrdiff_t n = 1 ) noexcept {
+			count_down( n );
+			wait( );
+		}
+	};
+} // namespace daw::process
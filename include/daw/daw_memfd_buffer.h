@@ -0,0 +1,303 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+#include <daw/daw_exception.h>
+
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		// The size of the data is kept at the start of the file so that every
+		// process holding the fd sees it
+		inline constexpr size_t memfd_header_size = cache_line_size;
+	} // namespace impl
+
+	// A read only mapping of the data in a memfd_buffer.  It stays valid after
+	// the buffer is gone
+	template<typename T>
+	class mapped_view {
+		static_assert( std::is_trivially_copyable_v<T> );
+
+		void *m_map = nullptr;
+		size_t m_map_size = 0;
+		size_t m_size = 0;
+
+	public:
+		using value_type = T;
+		using const_pointer = T const *;
+		using const_iterator = T const *;
+
+		mapped_view( ) noexcept = default;
+
+		explicit mapped_view( int fd ) {
+			m_map_size = impl::file_size( fd );
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  m_map_size < impl::memfd_header_size, "Invalid memfd_buffer" );
+			m_map = mmap( nullptr, m_map_size, PROT_READ, MAP_SHARED, fd, 0 );
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  m_map == MAP_FAILED, "Error mapping memfd_buffer" );
+			uint64_t bytes = 0;
+			memcpy( &bytes, m_map, sizeof( bytes ) );
+			m_size = static_cast<size_t>( bytes ) / sizeof( T );
+		}
+
+		~mapped_view( ) noexcept {
+			if( auto tmp = std::exchange( m_map, nullptr ); tmp ) {
+				munmap( tmp, m_map_size );
+			}
+		}
+
+		mapped_view( mapped_view const & ) = delete;
+		mapped_view &operator=( mapped_view const & ) = delete;
+
+		mapped_view( mapped_view &&other ) noexcept
+		  : m_map( std::exchange( other.m_map, nullptr ) )
+		  , m_map_size( std::exchange( other.m_map_size, 0 ) )
+		  , m_size( std::exchange( other.m_size, 0 ) ) {}
+
+		mapped_view &operator=( mapped_view &&rhs ) noexcept {
+			if( this != &rhs ) {
+				if( auto tmp = std::exchange( m_map, nullptr ); tmp ) {
+					munmap( tmp, m_map_size );
+				}
+				m_map = std::exchange( rhs.m_map, nullptr );
+				m_map_size = std::exchange( rhs.m_map_size, 0 );
+				m_size = std::exchange( rhs.m_size, 0 );
+			}
+			return *this;
+		}
+
+		const_pointer data( ) const noexcept {
+			if( !m_map ) {
+				return nullptr;
+			}
+			return std::launder( reinterpret_cast<T const *>(
+			  static_cast<char const *>( m_map ) + impl::memfd_header_size ) );
+		}
+
+		size_t size( ) const noexcept {
+			return m_size;
+		}
+
+		bool empty( ) const noexcept {
+			return m_size == 0;
+		}
+
+		const_iterator begin( ) const noexcept {
+			return data( );
+		}
+
+		const_iterator end( ) const noexcept {
+			return data( ) + m_size;
+		}
+
+		T const &operator[]( size_t idx ) const noexcept {
+			return data( )[idx];
+		}
+	};
+
+	// A byte buffer backed by a memfd that any process holding it can grow.
+	// The data is written through a mapping, there is no per element copy
+	// through a channel
+	class memfd_buffer {
+		int m_fd = -1;
+		bool m_is_copy = false;
+		// The mapping is per object, copies map the file on first use
+		void *m_map = nullptr;
+		size_t m_map_size = 0;
+
+		void unmap( ) noexcept {
+			if( auto tmp = std::exchange( m_map, nullptr ); tmp ) {
+				munmap( tmp, m_map_size );
+			}
+			m_map_size = 0;
+		}
+
+		void cleanup( ) noexcept {
+			unmap( );
+			if( !std::exchange( m_is_copy, true ) ) {
+				if( auto tmp = std::exchange( m_fd, -1 ); tmp >= 0 ) {
+					close( tmp );
+				}
+			}
+		}
+
+		void map( size_t map_size ) {
+			if( m_map and map_size <= m_map_size ) {
+				return;
+			}
+			void *result = MAP_FAILED;
+#if defined( __linux__ )
+			if( m_map ) {
+				result = mremap( m_map, m_map_size, map_size, MREMAP_MAYMOVE );
+			} else
+#endif
+			{
+				unmap( );
+				result = mmap( nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+				               m_fd, 0 );
+			}
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  result == MAP_FAILED, "Error mapping memfd_buffer" );
+			m_map = result;
+			m_map_size = map_size;
+		}
+
+		std::atomic<uint64_t> &size_header( ) noexcept {
+			return *std::launder(
+			  reinterpret_cast<std::atomic<uint64_t> *>( m_map ) );
+		}
+
+		// Make sure the file and our mapping can hold bytes of data
+		void reserve_bytes( size_t bytes ) {
+			auto const needed = impl::memfd_header_size + bytes;
+			auto file_size = impl::file_size( m_fd );
+			if( file_size < needed ) {
+				file_size = std::max( needed, file_size * 2 );
+				daw::exception::daw_throw_on_true<std::runtime_error>(
+				  ftruncate( m_fd, static_cast<off_t>( file_size ) ) != 0,
+				  "Error growing memfd_buffer" );
+			}
+			map( file_size );
+		}
+
+	public:
+		memfd_buffer( )
+		  : m_fd( impl::create_memfd( "daw_memfd_buffer" ) ) {
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  m_fd < 0, "Error creating memfd_buffer" );
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  ftruncate( m_fd, static_cast<off_t>( impl::memfd_header_size ) ) != 0,
+			  "Error sizing memfd_buffer" );
+		}
+
+		~memfd_buffer( ) noexcept {
+			cleanup( );
+		}
+
+		memfd_buffer( memfd_buffer const &other ) noexcept
+		  : m_fd( other.m_fd )
+		  , m_is_copy( true ) {}
+
+		memfd_buffer &operator=( memfd_buffer const &rhs ) noexcept {
+			if( this != &rhs ) {
+				cleanup( );
+				m_fd = rhs.m_fd;
+			}
+			return *this;
+		}
+
+		memfd_buffer( memfd_buffer &&other ) noexcept
+		  : m_fd( std::exchange( other.m_fd, -1 ) )
+		  , m_is_copy( std::exchange( other.m_is_copy, true ) )
+		  , m_map( std::exchange( other.m_map, nullptr ) )
+		  , m_map_size( std::exchange( other.m_map_size, 0 ) ) {}
+
+		memfd_buffer &operator=( memfd_buffer &&rhs ) noexcept {
+			if( this != &rhs ) {
+				cleanup( );
+				m_fd = std::exchange( rhs.m_fd, -1 );
+				m_is_copy = std::exchange( rhs.m_is_copy, true );
+				m_map = std::exchange( rhs.m_map, nullptr );
+				m_map_size = std::exchange( rhs.m_map_size, 0 );
+			}
+			return *this;
+		}
+
+		int native_handle( ) const noexcept {
+			return m_fd;
+		}
+
+		// Size of the data in bytes
+		size_t size( ) {
+			map( impl::file_size( m_fd ) );
+			return static_cast<size_t>(
+			  size_header( ).load( std::memory_order_acquire ) );
+		}
+
+		void *data( ) {
+			map( impl::file_size( m_fd ) );
+			return static_cast<char *>( m_map ) + impl::memfd_header_size;
+		}
+
+		void resize( size_t bytes ) {
+			reserve_bytes( bytes );
+			size_header( ).store( bytes, std::memory_order_release );
+		}
+
+		template<typename T>
+		void assign( T const *first, size_t count ) {
+			static_assert( std::is_trivially_copyable_v<T> );
+			auto const bytes = count * sizeof( T );
+			reserve_bytes( bytes );
+			if( bytes > 0 ) {
+				memcpy( static_cast<char *>( m_map ) + impl::memfd_header_size, first,
+				        bytes );
+			}
+			size_header( ).store( bytes, std::memory_order_release );
+		}
+
+		template<typename T>
+		void append( T const *first, size_t count ) {
+			static_assert( std::is_trivially_copyable_v<T> );
+			auto const old_bytes = size( );
+			auto const bytes = count * sizeof( T );
+			reserve_bytes( old_bytes + bytes );
+			if( bytes > 0 ) {
+				memcpy( static_cast<char *>( m_map ) + impl::memfd_header_size +
+				          old_bytes,
+				        first, bytes );
+			}
+			size_header( ).store( old_bytes + bytes, std::memory_order_release );
+		}
+
+		template<typename T>
+		mapped_view<T> view( ) const {
+			return mapped_view<T>( m_fd );
+		}
+
+		// Copy the data into a Container constructible from a pair of pointers,
+		// e.g. std::vector<T> or std::basic_string<T>
+		template<typename Container>
+		Container read( ) const {
+			using value_t = typename Container::value_type;
+			auto const v = view<value_t>( );
+			return Container( v.begin( ), v.end( ) );
+		}
+	};
+} // namespace daw::process
@@ -0,0 +1,240 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	// Bucket n of a histogram counts durations in [2^n, 2^(n+1)) ns
+	inline constexpr size_t metrics_histogram_size = 40;
+
+	// Which side of a primitive is acquired.  Channel writers and exclusive
+	// lock holders are the write side, channel readers and shared lock holders
+	// the read side
+	enum class metrics_side { read, write };
+
+	// How often one side was acquired and how long it had to wait
+	struct metrics_wait_snapshot {
+		uint64_t acquisitions = 0;
+		uint64_t blocked_waits = 0;
+		uint64_t wait_ns = 0;
+		std::array<uint64_t, metrics_histogram_size> wait_histogram{};
+	};
+
+	// A copy of the counters of one primitive
+	struct metrics_snapshot {
+		// Messages and payload bytes sent through a channel
+		uint64_t messages = 0;
+		uint64_t bytes = 0;
+		// Kept apart so a starved reader can be told from a blocked writer
+		metrics_wait_snapshot read{};
+		metrics_wait_snapshot write{};
+		// How long exclusive locks were held
+		uint64_t hold_ns = 0;
+		std::array<uint64_t, metrics_histogram_size> hold_histogram{};
+	};
+
+	namespace impl {
+		struct metrics_wait_state_t {
+			std::atomic<uint64_t> m_acquisitions;
+			std::atomic<uint64_t> m_blocked_waits;
+			std::atomic<uint64_t> m_wait_ns;
+			std::array<std::atomic<uint64_t>, metrics_histogram_size>
+			  m_wait_histogram;
+		};
+
+		struct metrics_state_t {
+			std::atomic<uint64_t> m_messages;
+			std::atomic<uint64_t> m_bytes;
+			metrics_wait_state_t m_read;
+			metrics_wait_state_t m_write;
+			std::atomic<uint64_t> m_hold_ns;
+			std::array<std::atomic<uint64_t>, metrics_histogram_size>
+			  m_hold_histogram;
+		};
+
+		constexpr size_t histogram_bucket( uint64_t ns ) noexcept {
+			size_t result = 0;
+			while( ns > 1 and result + 1 < metrics_histogram_size ) {
+				ns >>= 1U;
+				++result;
+			}
+			return result;
+		}
+
+		inline uint64_t now_ns( ) noexcept {
+			return static_cast<uint64_t>(
+			  std::chrono::duration_cast<std::chrono::nanoseconds>(
+			    std::chrono::steady_clock::now( ).time_since_epoch( ) )
+			    .count( ) );
+		}
+	} // namespace impl
+
+	// The metrics policies are a template parameter of the channels and locks.
+	// no_metrics is the default and compiles away, shared_metrics keeps the
+	// counters in shared memory so that any process attached to the primitive
+	// can take a snapshot
+	struct no_metrics {
+		static constexpr bool is_enabled = false;
+
+		no_metrics( ) noexcept = default;
+		no_metrics( open_or_create_t, std::string const & ) noexcept {}
+
+		static bool remove( std::string const & ) noexcept {
+			return true;
+		}
+
+		// Call acquire( ), try_acquire( ) is only used to detect blocking
+		template<typename TryAcquire, typename Acquire>
+		void acquire( metrics_side, TryAcquire &&, Acquire &&acquire ) {
+			acquire( );
+		}
+
+		constexpr void record_acquired( metrics_side ) noexcept {}
+		constexpr void record_message( size_t ) noexcept {}
+		constexpr void record_locked( ) noexcept {}
+		constexpr void record_released( ) noexcept {}
+
+		metrics_snapshot snapshot( ) const noexcept {
+			return {};
+		}
+	};
+
+	namespace impl {
+		template<typename Metrics, typename Semaphore>
+		void metered_wait( Metrics &metrics, metrics_side side, Semaphore &sem ) {
+			metrics.acquire(
+			  side, [&] { return sem.try_wait( ); }, [&] { sem.wait( ); } );
+		}
+
+		inline metrics_wait_snapshot
+		snapshot_of( metrics_wait_state_t const &st ) noexcept {
+			auto result = metrics_wait_snapshot{};
+			result.acquisitions = st.m_acquisitions.load( std::memory_order_relaxed );
+			result.blocked_waits =
+			  st.m_blocked_waits.load( std::memory_order_relaxed );
+			result.wait_ns = st.m_wait_ns.load( std::memory_order_relaxed );
+			for( size_t n = 0; n < metrics_histogram_size; ++n ) {
+				result.wait_histogram[n] =
+				  st.m_wait_histogram[n].load( std::memory_order_relaxed );
+			}
+			return result;
+		}
+	} // namespace impl
+
+	class shared_metrics {
+		shared_memory<impl::metrics_state_t> m_state{};
+		// When the exclusive lock held through this object was acquired.  Only
+		// written and read while that lock is held, so the lock orders it
+		uint64_t m_acquired_at = 0;
+
+		impl::metrics_state_t &state( ) noexcept {
+			return *m_state.data( );
+		}
+
+		impl::metrics_state_t const &state( ) const noexcept {
+			return *m_state.data( );
+		}
+
+		impl::metrics_wait_state_t &side_state( metrics_side side ) noexcept {
+			return side == metrics_side::read ? state( ).m_read : state( ).m_write;
+		}
+
+	public:
+		static constexpr bool is_enabled = true;
+
+		shared_metrics( ) noexcept = default;
+
+		shared_metrics( open_or_create_t, std::string const &name )
+		  : m_state( open_or_create, name ) {}
+
+		static bool remove( std::string const &name ) noexcept {
+			return shared_memory<impl::metrics_state_t>::remove( name );
+		}
+
+		// Call try_acquire( ) and if that fails, time the blocking acquire( )
+		template<typename TryAcquire, typename Acquire>
+		void acquire( metrics_side side, TryAcquire &&try_acquire,
+		              Acquire &&acquire ) {
+			auto &st = side_state( side );
+			if( !try_acquire( ) ) {
+				auto const start = impl::now_ns( );
+				acquire( );
+				auto const waited = impl::now_ns( ) - start;
+				st.m_blocked_waits.fetch_add( 1, std::memory_order_relaxed );
+				st.m_wait_ns.fetch_add( waited, std::memory_order_relaxed );
+				st.m_wait_histogram[impl::histogram_bucket( waited )].fetch_add(
+				  1, std::memory_order_relaxed );
+			}
+			record_acquired( side );
+		}
+
+		void record_acquired( metrics_side side ) noexcept {
+			side_state( side ).m_acquisitions.fetch_add( 1,
+			                                             std::memory_order_relaxed );
+		}
+
+		void record_message( size_t bytes ) noexcept {
+			auto &st = state( );
+			st.m_messages.fetch_add( 1, std::memory_order_relaxed );
+			st.m_bytes.fetch_add( bytes, std::memory_order_relaxed );
+		}
+
+		// Only used by exclusive locks, after acquiring them.  Shared holds are
+		// not timed as several readers would share the one timestamp
+		void record_locked( ) noexcept {
+			m_acquired_at = impl::now_ns( );
+		}
+
+		// Only used by exclusive locks, records how long it was held
+		void record_released( ) noexcept {
+			auto &st = state( );
+			auto const held = impl::now_ns( ) - m_acquired_at;
+			st.m_hold_ns.fetch_add( held, std::memory_order_relaxed );
+			st.m_hold_histogram[impl::histogram_bucket( held )].fetch_add(
+			  1, std::memory_order_relaxed );
+		}
+
+		metrics_snapshot snapshot( ) const noexcept {
+			auto const &st = state( );
+			auto result = metrics_snapshot{};
+			result.messages = st.m_messages.load( std::memory_order_relaxed );
+			result.bytes = st.m_bytes.load( std::memory_order_relaxed );
+			result.read = impl::snapshot_of( st.m_read );
+			result.write = impl::snapshot_of( st.m_write );
+			result.hold_ns = st.m_hold_ns.load( std::memory_order_relaxed );
+			for( size_t n = 0; n < metrics_histogram_size; ++n ) {
+				result.hold_histogram[n] =
+				  st.m_hold_histogram[n].load( std::memory_order_relaxed );
+			}
+			return result;
+		}
+	};
+} // namespace daw::process
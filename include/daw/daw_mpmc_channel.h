@@ -0,0 +1,207 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include "daw_futex.h"
+#include "daw_metrics.h"
+#include "daw_pollable.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		template<typename T>
+		struct mpmc_slot_t {
+			std::atomic<size_t> m_sequence;
+			T m_value;
+		};
+
+		template<typename T, size_t Capacity>
+		struct mpmc_t {
+			alignas( cache_line_size ) std::atomic<size_t> m_enqueue_pos;
+			alignas( cache_line_size ) std::atomic<size_t> m_dequeue_pos;
+			alignas( cache_line_size ) waiters_t m_readers;
+			alignas( cache_line_size ) waiters_t m_writers;
+			alignas( cache_line_size ) std::array<mpmc_slot_t<T>, Capacity> m_slots;
+		};
+	} // namespace impl
+
+	// A bounded multi producer/multi consumer channel.  Each slot carries a
+	// sequence number so that producers and consumers only contend on their
+	// own position counter and not on a common lock.  With Poll set to
+	// pollable, poll_handle( ) becomes readable on writes
+	template<typename T, size_t Capacity = 64, typename Metrics = no_metrics,
+	         typename Poll = not_pollable>
+	class mpmc_channel : private Metrics, private Poll {
+		static_assert( std::is_trivially_copyable_v<T> );
+		static_assert( std::is_default_constructible_v<T> );
+		static_assert( Capacity > 0 );
+
+		using queue_t = impl::mpmc_t<T, Capacity>;
+
+		daw::process::shared_memory<queue_t> m_queue{};
+
+		queue_t &queue( ) noexcept {
+			return *m_queue.data( );
+		}
+
+		bool push( T const &value ) noexcept {
+			auto &q = queue( );
+			auto pos = q.m_enqueue_pos.load( std::memory_order_relaxed );
+			impl::mpmc_slot_t<T> *slot = nullptr;
+			while( true ) {
+				slot = &q.m_slots[pos % Capacity];
+				auto const seq = slot->m_sequence.load( std::memory_order_acquire );
+				if( seq == pos ) {
+					if( q.m_enqueue_pos.compare_exchange_weak(
+					      pos, pos + 1, std::memory_order_relaxed ) ) {
+						break;
+					}
+				} else if( seq < pos ) {
+					// The consumer of the previous lap has not released it, full
+					return false;
+				} else {
+					pos = q.m_enqueue_pos.load( std::memory_order_relaxed );
+				}
+			}
+			slot->m_value = value;
+			slot->m_sequence.store( pos + 1, std::memory_order_seq_cst );
+			// Only pay for the notify when a reader is asleep
+			if( q.m_readers.m_waiters.load( std::memory_order_seq_cst ) > 0 ) {
+				impl::notify( q.m_readers );
+			}
+			this->notify_poll_handle( );
+			return true;
+		}
+
+		std::optional<T> pop( ) noexcept {
+			auto &q = queue( );
+			auto pos = q.m_dequeue_pos.load( std::memory_order_relaxed );
+			impl::mpmc_slot_t<T> *slot = nullptr;
+			while( true ) {
+				slot = &q.m_slots[pos % Capacity];
+				auto const seq = slot->m_sequence.load( std::memory_order_acquire );
+				if( seq == pos + 1 ) {
+					if( q.m_dequeue_pos.compare_exchange_weak(
+					      pos, pos + 1, std::memory_order_relaxed ) ) {
+						break;
+					}
+				} else if( seq < pos + 1 ) {
+					// Nothing has been produced into this slot yet, empty
+					return std::nullopt;
+				} else {
+					pos = q.m_dequeue_pos.load( std::memory_order_relaxed );
+				}
+			}
+			T result = slot->m_value;
+			slot->m_sequence.store( pos + Capacity, std::memory_order_seq_cst );
+			if( q.m_writers.m_waiters.load( std::memory_order_seq_cst ) > 0 ) {
+				impl::notify( q.m_writers );
+			}
+			return result;
+		}
+
+	public:
+		mpmc_channel( ) noexcept( std::is_nothrow_default_constructible_v<Poll> )
+		  : mpmc_channel( shared_memory_options{} ) {}
+
+		explicit mpmc_channel( shared_memory_options const &opts ) noexcept(
+		  std::is_nothrow_default_constructible_v<Poll> )
+		  : m_queue( opts ) {
+			for( size_t n = 0; n < Capacity; ++n ) {
+				queue( ).m_slots[n].m_sequence.store( n, std::memory_order_relaxed );
+			}
+			std::atomic_thread_fence( std::memory_order_release );
+		}
+
+		static constexpr size_t capacity( ) noexcept {
+			return Capacity;
+		}
+
+		// True when a read would not wait, unless another reader takes the value
+		// first
+		bool is_readable( ) noexcept {
+			auto const &q = queue( );
+			auto const pos = q.m_dequeue_pos.load( std::memory_order_seq_cst );
+			return q.m_slots[pos % Capacity].m_sequence.load(
+			         std::memory_order_acquire ) == pos + 1;
+		}
+
+		// The pollable fd, or -1 when Poll is not_pollable
+		int poll_handle( ) const noexcept {
+			return Poll::poll_handle( );
+		}
+
+		void drain_poll_handle( ) noexcept {
+			Poll::drain_poll_handle( );
+		}
+
+		void write( T const &value ) noexcept {
+			auto const try_push = [&] { return push( value ); };
+			this->acquire( metrics_side::write, try_push, [&] {
+				impl::wait_until( queue( ).m_writers, try_push );
+			} );
+			this->record_message( sizeof( T ) );
+		}
+
+		bool try_write( T const &value ) noexcept {
+			if( push( value ) ) {
+				this->record_acquired( metrics_side::write );
+				this->record_message( sizeof( T ) );
+				return true;
+			}
+			return false;
+		}
+
+		T read( ) noexcept {
+			auto result = std::optional<T>( );
+			auto const try_pop = [&] {
+				result = pop( );
+				return result.has_value( );
+			};
+			this->acquire( metrics_side::read, try_pop, [&] {
+				impl::wait_until( queue( ).m_readers, try_pop );
+			} );
+			return *result;
+		}
+
+		std::optional<T> try_read( ) noexcept {
+			auto result = pop( );
+			if( result ) {
+				this->record_acquired( metrics_side::read );
+			}
+			return result;
+		}
+
+		// Counters of this channel, all zero unless Metrics is shared_metrics
+		metrics_snapshot metrics( ) const noexcept {
+			return Metrics::snapshot( );
+		}
+	};
+} // namespace daw::process
@@ -0,0 +1,254 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <future>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include <daw/daw_exception.h>
+
+#include "daw_process.h"
+#include "daw_process_pool.h"
+#include "daw_shared_memory.h"
+
+// Data parallel algorithms that split their input into one chunk per worker
+// process.  The forked workers see the input copy on write, so nothing is
+// sent to them; only results come back through shared memory.  A callable
+// that throws or exits in a worker makes the algorithm throw in the caller
+namespace daw::process {
+	namespace impl {
+		inline size_t default_worker_count( ) noexcept {
+			auto const result = std::thread::hardware_concurrency( );
+			return result > 0 ? static_cast<size_t>( result ) : 1U;
+		}
+
+		inline size_t chunk_bound( size_t count, size_t chunk_count,
+		                           size_t chunk ) noexcept {
+			return ( count * chunk ) / chunk_count;
+		}
+
+		// Fork a child per chunk of [0, count) that runs
+		// chunk_func( chunk, first, last ) and wait for all of them.  Returns the
+		// number of chunks
+		template<typename ChunkFunction>
+		size_t fork_chunks( size_t count, size_t worker_count,
+		                    ChunkFunction chunk_func ) {
+			if( count == 0 ) {
+				return 0;
+			}
+			auto const chunk_count = std::clamp<size_t>( worker_count, 1U, count );
+			auto done = shared_memory<bool[]>( chunk_count );
+			{
+				auto workers = std::vector<fork_process<>>( );
+				workers.reserve( chunk_count );
+				for( size_t n = 0; n < chunk_count; ++n ) {
+					workers.emplace_back( [&, n] {
+						// An exception must not unwind into the caller's code in the
+						// child, where it would go on forking.  Leave without done[n]
+						try {
+							chunk_func( n, chunk_bound( count, chunk_count, n ),
+							            chunk_bound( count, chunk_count, n + 1 ) );
+						} catch( ... ) { _exit( EXIT_FAILURE ); }
+						done[n] = true;
+					} );
+				}
+			}
+			daw::exception::daw_throw_on_false<std::runtime_error>(
+			  std::all_of( done.begin( ), done.end( ),
+			               []( bool b ) { return b; } ),
+			  "Error running callable" );
+			return chunk_count;
+		}
+
+		// Run chunk_func( first, last ) for each chunk of [0, count) on the pool
+		// and return the futures of the results
+		template<typename ChunkFunction>
+		auto pool_chunks( process_pool &pool, size_t count,
+		                  ChunkFunction chunk_func ) {
+			using result_t = decltype( chunk_func( size_t{}, size_t{} ) );
+			auto results = std::vector<std::future<result_t>>( );
+			if( count == 0 ) {
+				return results;
+			}
+			auto const chunk_count = std::clamp<size_t>( pool.size( ), 1U, count );
+			results.reserve( chunk_count );
+			for( size_t n = 0; n < chunk_count; ++n ) {
+				results.push_back(
+				  pool.async( chunk_func, chunk_bound( count, chunk_count, n ),
+				              chunk_bound( count, chunk_count, n + 1 ) ) );
+			}
+			return results;
+		}
+
+		template<typename RandomIterator, typename Transform>
+		using transform_result_t =
+		  std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<
+		    Transform, decltype( *std::declval<RandomIterator>( ) )>>>;
+
+		template<typename RandomIterator>
+		RandomIterator nth( RandomIterator it, size_t n ) {
+			return std::next( it, static_cast<std::ptrdiff_t>( n ) );
+		}
+
+		// Reduce a non-empty chunk without needing an identity value
+		template<typename T, typename RandomIterator, typename Reduce,
+		         typename Transform>
+		T reduce_chunk( RandomIterator first, size_t b, size_t e,
+		                Reduce const &reduce, Transform const &func ) {
+			auto it = impl::nth( first, b );
+			auto const last = impl::nth( first, e );
+			T result = func( *it );
+			while( ++it != last ) {
+				result = reduce( std::move( result ), func( *it ) );
+			}
+			return result;
+		}
+	} // namespace impl
+
+	// Call func( value ) for each value in [first, last).  Only side effects on
+	// shared memory are seen by the caller
+	template<typename RandomIterator, typename Function>
+	void parallel_for( RandomIterator first, RandomIterator last, Function func,
+	                   size_t worker_count = impl::default_worker_count( ) ) {
+		auto const count = static_cast<size_t>( std::distance( first, last ) );
+		impl::fork_chunks( count, worker_count, [&]( size_t, size_t b, size_t e ) {
+			std::for_each( impl::nth( first, b ),
+			               impl::nth( first, e ),
+			               func );
+		} );
+	}
+
+	// Write func( value ) for each value in [first, last) to d_first.  The
+	// results must be trivially copyable
+	template<typename RandomIterator, typename OutputIterator,
+	         typename Transform>
+	OutputIterator
+	transform( RandomIterator first, RandomIterator last, OutputIterator d_first,
+	           Transform func,
+	           size_t worker_count = impl::default_worker_count( ) ) {
+		using result_t = impl::transform_result_t<RandomIterator, Transform>;
+		static_assert( std::is_trivially_copyable_v<result_t> );
+		auto const count = static_cast<size_t>( std::distance( first, last ) );
+		if( count == 0 ) {
+			return d_first;
+		}
+		auto results = shared_memory<result_t[]>( count );
+		impl::fork_chunks( count, worker_count, [&]( size_t, size_t b, size_t e ) {
+			std::transform( impl::nth( first, b ),
+			                impl::nth( first, e ),
+			                results.begin( ) + b, func );
+		} );
+		return std::copy( results.begin( ), results.end( ), d_first );
+	}
+
+	// reduce( init, transform( value ) ) over [first, last).  Each worker
+	// reduces its own chunk and the caller reduces init with the partial
+	// results in order, so reduce must be associative
+	template<typename RandomIterator, typename T, typename Reduce,
+	         typename Transform>
+	T transform_reduce( RandomIterator first, RandomIterator last, T init,
+	                    Reduce reduce, Transform func,
+	                    size_t worker_count = impl::default_worker_count( ) ) {
+		static_assert( std::is_trivially_copyable_v<T> );
+		static_assert( std::is_default_constructible_v<T> );
+		auto const count = static_cast<size_t>( std::distance( first, last ) );
+		if( count == 0 ) {
+			return init;
+		}
+		auto partials =
+		  shared_memory<T[]>( std::clamp<size_t>( worker_count, 1U, count ) );
+		auto const chunk_count = impl::fork_chunks(
+		  count, worker_count, [&]( size_t chunk, size_t b, size_t e ) {
+			  partials[chunk] = impl::reduce_chunk<T>( first, b, e, reduce, func );
+		  } );
+		for( size_t n = 0; n < chunk_count; ++n ) {
+			init = reduce( std::move( init ), partials[n] );
+		}
+		return init;
+	}
+
+	// The pooled versions run one chunk per worker of pool.  Pool workers are
+	// forked when the pool is created, so the input, and the output of
+	// transform, must be in shared memory or have existed before the pool.
+	// func and the iterators must be trivially copyable
+	template<typename RandomIterator, typename Function>
+	void parallel_for( process_pool &pool, RandomIterator first,
+	                   RandomIterator last, Function func ) {
+		auto const count = static_cast<size_t>( std::distance( first, last ) );
+		auto results =
+		  impl::pool_chunks( pool, count, [first, func]( size_t b, size_t e ) {
+			  std::for_each( impl::nth( first, b ),
+			                 impl::nth( first, e ),
+			                 func );
+		  } );
+		for( auto &result : results ) {
+			result.get( );
+		}
+	}
+
+	template<typename RandomIterator, typename RandomOutputIterator,
+	         typename Transform>
+	RandomOutputIterator transform( process_pool &pool, RandomIterator first,
+	                                RandomIterator last,
+	                                RandomOutputIterator d_first,
+	                                Transform func ) {
+		auto const count = static_cast<size_t>( std::distance( first, last ) );
+		auto results = impl::pool_chunks(
+		  pool, count, [first, d_first, func]( size_t b, size_t e ) {
+			  std::transform( impl::nth( first, b ),
+			                  impl::nth( first, e ),
+			                  impl::nth( d_first, b ),
+			                  func );
+		  } );
+		for( auto &result : results ) {
+			result.get( );
+		}
+		return impl::nth( d_first, count );
+	}
+
+	template<typename RandomIterator, typename T, typename Reduce,
+	         typename Transform>
+	T transform_reduce( process_pool &pool, RandomIterator first,
+	                    RandomIterator last, T init, Reduce reduce,
+	                    Transform func ) {
+		auto const count = static_cast<size_t>( std::distance( first, last ) );
+		auto results = impl::pool_chunks(
+		  pool, count, [first, reduce, func]( size_t b, size_t e ) -> T {
+			  return impl::reduce_chunk<T>( first, b, e, reduce, func );
+		  } );
+		for( auto &result : results ) {
+			init = reduce( std::move( init ), result.get( ) );
+		}
+		return init;
+	}
+} // namespace daw::process
@@ -0,0 +1,223 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <limits>
+#include <optional>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+#include <utility>
+
+#include <daw/daw_exception.h>
+
+#if defined( __linux__ )
+#include <sys/eventfd.h>
+#endif
+
+namespace daw::process {
+	// The poll policies are a template parameter of channel, ring_channel and
+	// mpmc_channel.  not_pollable is the default and adds nothing, pollable
+	// gives the channel an fd that is made readable by writes so that select,
+	// poll or an event loop can wait on several channels at once
+	struct not_pollable {
+		static constexpr bool is_enabled = false;
+
+		constexpr void notify_poll_handle( ) noexcept {}
+
+		constexpr int poll_handle( ) const noexcept {
+			return -1;
+		}
+
+		constexpr void drain_poll_handle( ) noexcept {}
+	};
+
+	// An eventfd, or a pipe elsewhere, shared with children forked afterwards.
+	// Copies share the fds of the original, which closes them
+	class pollable {
+		int m_read_fd = -1;
+		int m_write_fd = -1;
+		bool m_is_copy = false;
+
+		void cleanup( ) noexcept {
+			if( !std::exchange( m_is_copy, true ) ) {
+				auto const read_fd = std::exchange( m_read_fd, -1 );
+				auto const write_fd = std::exchange( m_write_fd, -1 );
+				if( read_fd >= 0 ) {
+					close( read_fd );
+				}
+				if( write_fd >= 0 and write_fd != read_fd ) {
+					close( write_fd );
+				}
+			}
+		}
+
+	public:
+		static constexpr bool is_enabled = true;
+
+		pollable( ) {
+#if defined( __linux__ )
+			m_read_fd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+			m_write_fd = m_read_fd;
+#else
+			auto fds = std::array<int, 2>{-1, -1};
+			if( pipe( fds.data( ) ) == 0 ) {
+				for( auto fd : fds ) {
+					fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+					fcntl( fd, F_SETFD, FD_CLOEXEC );
+				}
+				m_read_fd = fds[0];
+				m_write_fd = fds[1];
+			}
+#endif
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  m_read_fd < 0, "Error creating pollable fd" );
+		}
+
+		~pollable( ) noexcept {
+			cleanup( );
+		}
+
+		pollable( pollable const &other ) noexcept
+		  : m_read_fd( other.m_read_fd )
+		  , m_write_fd( other.m_write_fd )
+		  , m_is_copy( true ) {}
+
+		pollable &operator=( pollable const &rhs ) noexcept {
+			if( this != &rhs ) {
+				cleanup( );
+				m_read_fd = rhs.m_read_fd;
+				m_write_fd = rhs.m_write_fd;
+				m_is_copy = true;
+			}
+			return *this;
+		}
+
+		pollable( pollable &&other ) noexcept
+		  : m_read_fd( std::exchange( other.m_read_fd, -1 ) )
+		  , m_write_fd( std::exchange( other.m_write_fd, -1 ) )
+		  , m_is_copy( std::exchange( other.m_is_copy, true ) ) {}
+
+		pollable &operator=( pollable &&rhs ) noexcept {
+			if( this != &rhs ) {
+				cleanup( );
+				m_read_fd = std::exchange( rhs.m_read_fd, -1 );
+				m_write_fd = std::exchange( rhs.m_write_fd, -1 );
+				m_is_copy = std::exchange( rhs.m_is_copy, true );
+			}
+			return *this;
+		}
+
+		void notify_poll_handle( ) noexcept {
+#if defined( __linux__ )
+			uint64_t const value = 1;
+#else
+			char const value = 1;
+#endif
+			// A full pipe or counter is already readable
+			(void)!write( m_write_fd, &value, sizeof( value ) );
+		}
+
+		int poll_handle( ) const noexcept {
+			return m_read_fd;
+		}
+
+		// Reset the fd to not readable
+		void drain_poll_handle( ) noexcept {
+			auto buff = std::array<char, 64>{};
+			while( read( m_read_fd, buff.data( ), buff.size( ) ) > 0 ) {}
+		}
+	};
+
+	// Wait until one of the pollable channels has a value and return its
+	// index, or std::nullopt after timeout.  Channels report readiness with
+	// is_readable( ) so select does not take the value.  Use one consumer per
+	// channel, as a wake-up can be taken by another process selecting on it
+	template<typename Rep, typename Period, typename... Channels>
+	std::optional<size_t> select_for( std::chrono::duration<Rep, Period> timeout,
+	                                  Channels &... channels ) {
+		static_assert( sizeof...( Channels ) > 0 );
+		auto fds = std::array<pollfd, sizeof...( Channels )>{
+		  pollfd{channels.poll_handle( ), POLLIN, 0}...};
+		daw::exception::daw_throw_on_true<std::invalid_argument>(
+		  std::any_of( fds.begin( ), fds.end( ),
+		               []( pollfd const &p ) { return p.fd < 0; } ),
+		  "select requires pollable channels" );
+
+		auto const is_forever = timeout < timeout.zero( );
+		// Clamped so that now( ) + wait cannot overflow, e.g. for hours::max( )
+		constexpr auto max_wait = std::chrono::hours( 24 * 365 );
+		auto const wait =
+		  is_forever ? std::chrono::nanoseconds( 0 )
+		  : timeout >= max_wait
+		    ? std::chrono::duration_cast<std::chrono::nanoseconds>( max_wait )
+		    : std::chrono::duration_cast<std::chrono::nanoseconds>( timeout );
+		auto const deadline = std::chrono::steady_clock::now( ) + wait;
+		while( true ) {
+			size_t index = 0;
+			auto result = std::optional<size_t>( );
+			// Left to right, the first readable channel wins
+			(void)( ( channels.is_readable( ) ? ( result = index, true )
+			                                  : ( ++index, false ) ) or
+			        ... );
+			if( result ) {
+				return result;
+			}
+			int wait_ms = -1;
+			if( !is_forever ) {
+				auto const left = deadline - std::chrono::steady_clock::now( );
+				if( left <= left.zero( ) ) {
+					return std::nullopt;
+				}
+				// Round up so that a short wait does not become a spin
+				wait_ms = static_cast<int>( std::min<std::chrono::milliseconds::rep>(
+				  std::chrono::ceil<std::chrono::milliseconds>( left ).count( ),
+				  std::numeric_limits<int>::max( ) ) );
+			}
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  poll( fds.data( ), fds.size( ), wait_ms ) < 0 and errno != EINTR,
+			  "Error polling" );
+			// Drain before checking again so that a write after the check still
+			// makes the fd readable
+			index = 0;
+			( ( ( fds[index++].revents & POLLIN ) != 0
+			      ? channels.drain_poll_handle( )
+			      : void( ) ),
+			  ... );
+		}
+	}
+
+	// Wait until one of the pollable channels has a value and return its
+	// index
+	template<typename... Channels>
+	size_t select( Channels &... channels ) {
+		return *select_for( std::chrono::milliseconds( -1 ), channels... );
+	}
+} // namespace daw::process
@@ -22,15 +22,178 @@
 
 #pragma once
 
+#include <array>
+#include <climits>
+#include <csignal>
 #include <cstddef>
 #include <functional>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
+#include <type_traits>
 #include <unistd.h>
+#include <vector>
+
+#if defined( __linux__ )
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
 
 #include <daw/daw_exception.h>
+#include <daw/daw_traits.h>
 
 namespace daw::process {
-	template<bool wait_on_pid = true>
+	// Where and how a child runs, applied in the child before the callable.
+	// All of these are best effort, the callable still runs if the system
+	// refuses one of them
+	struct launch_options {
+		// Pin the child to these CPUs, when not empty
+		std::vector<int> cpus{};
+		// SCHED_OTHER, SCHED_BATCH, SCHED_IDLE, SCHED_FIFO or SCHED_RR, when
+		// non-negative
+		int sched_policy = -1;
+		// The static priority for SCHED_FIFO and SCHED_RR
+		int sched_priority = 0;
+		// The nice value for the other policies, when in [-20, 19]
+		int nice = INT_MAX;
+		// Allocate the child's memory from this NUMA node, when non-negative
+		int numa_node = -1;
+	};
+
+	namespace impl {
+		inline void apply_launch_options( launch_options const &opts ) noexcept {
+#if defined( __linux__ )
+			if( !opts.cpus.empty( ) ) {
+				cpu_set_t set;
+				CPU_ZERO( &set );
+				for( auto cpu : opts.cpus ) {
+					if( cpu >= 0 and cpu < CPU_SETSIZE ) {
+						CPU_SET( cpu, &set );
+					}
+				}
+				(void)sched_setaffinity( 0, sizeof( set ), &set );
+			}
+			if( opts.sched_policy >= 0 ) {
+				auto param = sched_param{};
+				param.sched_priority = opts.sched_priority;
+				(void)sched_setscheduler( 0, opts.sched_policy, &param );
+			}
+#endif
+			if( opts.nice >= -20 and opts.nice <= 19 ) {
+				(void)setpriority( PRIO_PROCESS, 0, opts.nice );
+			}
+#if defined( __linux__ ) and defined( SYS_set_mempolicy )
+			if( opts.numa_node >= 0 ) {
+				static constexpr size_t bits_per_word =
+				  sizeof( unsigned long ) * CHAR_BIT;
+				auto mask = std::array<unsigned long, 16>{};
+				auto const n = static_cast<size_t>( opts.numa_node );
+				if( n < mask.size( ) * bits_per_word ) {
+					mask[n / bits_per_word] = 1UL << ( n % bits_per_word );
+					(void)syscall( SYS_set_mempolicy, MPOL_BIND, mask.data( ),
+					               mask.size( ) * bits_per_word + 1U );
+				}
+			}
+#endif
+		}
+	} // namespace impl
+
+	// Spawn the child with fork( ).  The child gets a copy on write image of
+	// the parent, which costs page tables proportional to the parent's RSS
+	struct fork_spawn {
+		template<typename Child>
+		static ::pid_t spawn( Child &child ) noexcept {
+			auto const pid = fork( );
+			if( pid == 0 ) {
+				child( );
+				exit( 0 );
+			}
+			return pid;
+		}
+	};
+
+	// Spawn the child with clone( CLONE_VM | CLONE_VFORK ) on a stack of its
+	// own, like posix_spawn does.  Nothing is copied so the cost does not grow
+	// with the parent's RSS, but the child runs in the parent's memory and the
+	// spawning thread is suspended until the child calls exec or exits.  It is
+	// meant for children that exec and for short callables.  These must not
+	// touch the parent's locks or return through exceptions and their writes
+	// are seen by the parent.  The child leaves with _exit so the parent's
+	// atexit handlers and stdio buffers are left alone.  Elsewhere it is
+	// fork_spawn
+	struct vfork_spawn {
+		static constexpr size_t stack_size = 8U * 1024U * 1024U;
+
+#if defined( __linux__ )
+	private:
+		template<typename Child>
+		struct start_t {
+			Child *child;
+			sigset_t const *mask;
+		};
+
+		template<typename Child>
+		static int run( void *arg ) noexcept {
+			auto const &start = *static_cast<start_t<Child> *>( arg );
+			// Like posix_spawn, the parent's handlers are reset before signals are
+			// unblocked.  The child has its own handler table, so this does not
+			// change the parent's
+			for( int sig = 1; sig < NSIG; ++sig ) {
+				struct sigaction action {};
+				if( sigaction( sig, nullptr, &action ) == 0 and
+				    action.sa_handler != SIG_DFL and action.sa_handler != SIG_IGN ) {
+					action = {};
+					action.sa_handler = SIG_DFL;
+					sigaction( sig, &action, nullptr );
+				}
+			}
+			pthread_sigmask( SIG_SETMASK, start.mask, nullptr );
+			( *start.child )( );
+			_exit( 0 );
+		}
+
+	public:
+		template<typename Child>
+		static ::pid_t spawn( Child &child ) noexcept {
+			void *stack = mmap( nullptr, stack_size, PROT_READ | PROT_WRITE,
+			                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE |
+			                      MAP_STACK,
+			                    -1, 0 );
+			if( stack == MAP_FAILED ) {
+				return -1;
+			}
+			// Signal handlers must not run in the child before it is ready, they
+			// would share the parent's memory
+			sigset_t all;
+			sigset_t old;
+			sigfillset( &all );
+			pthread_sigmask( SIG_SETMASK, &all, &old );
+			auto start = start_t<Child>{&child, &old};
+			auto const pid =
+			  clone( &run<Child>, static_cast<char *>( stack ) + stack_size,
+			         CLONE_VM | CLONE_VFORK | SIGCHLD, &start );
+			pthread_sigmask( SIG_SETMASK, &old, nullptr );
+			// The child has exited or exec'd and no longer uses the stack
+			munmap( stack, stack_size );
+			return pid;
+		}
+#else
+		template<typename Child>
+		static ::pid_t spawn( Child &child ) noexcept {
+			return fork_spawn::spawn( child );
+		}
+#endif
+	};
+
+	// Selects the fork_process constructor that takes ownership of an existing
+	// child process
+	struct adopt_process_t {
+		explicit adopt_process_t( ) = default;
+	};
+	inline constexpr adopt_process_t adopt_process{};
+
+	template<bool wait_on_pid = true, typename SpawnPolicy = fork_spawn>
 	struct fork_process {
 		using native_handle_type = ::pid_t;
 
@@ -40,18 +203,31 @@ namespace daw::process {
 	public:
 		constexpr fork_process( ) noexcept = default;
 
+		template<typename Function, typename... Args,
+		         std::enable_if_t<not std::is_same_v<daw::remove_cvref_t<Function>,
+		                                             launch_options>,
+		                          std::nullptr_t> = nullptr>
+		fork_process( Function &&func, Args &&... args ) noexcept
+		  : fork_process( launch_options{}, std::forward<Function>( func ),
+		                  std::forward<Args>( args )... ) {}
+
 		template<typename Function, typename... Args>
-		fork_process( Function &&func, Args &&... args ) noexcept {
-			m_pid = fork( );
-			daw::exception::daw_throw_on_true<std::runtime_error>( m_pid < 0,
-			                                                       "Error forking" );
-			if( m_pid == 0 ) {
+		fork_process( launch_options const &opts, Function &&func,
+		              Args &&... args ) noexcept {
+			auto child = [&]( ) {
+				impl::apply_launch_options( opts );
 				(void)std::invoke( std::forward<Function>( func ),
 				                   std::forward<Args>( args )... );
-				exit( 0 );
-			}
+			};
+			m_pid = SpawnPolicy::spawn( child );
+			daw::exception::daw_throw_on_true<std::runtime_error>( m_pid < 0,
+			                                                       "Error forking" );
 		}
 
+		// pid must be a child of this process so that it can be waited on
+		constexpr fork_process( adopt_process_t, native_handle_type pid ) noexcept
+		  : m_pid( pid ) {}
+
 		fork_process( fork_process const & ) = delete;
 		fork_process &operator=( fork_process const & ) = delete;
 
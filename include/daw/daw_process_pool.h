@@ -0,0 +1,304 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <daw/daw_exception.h>
+
+#include "daw_mpmc_channel.h"
+#include "daw_process.h"
+#include "daw_process_reaper.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		inline constexpr size_t pool_task_size = 128;
+		inline constexpr size_t pool_result_size = 128;
+		inline constexpr size_t pool_queue_size = 256;
+
+		// The workers are forked from the process that owns the pool, so the
+		// address of an instantiation of invoke_pool_task is the same in all of
+		// them and can be sent along with the bytes of the callable
+		using pool_invoke_t = void ( * )( void const *, void * );
+
+		struct pool_task_t {
+			uint64_t m_id;
+			pool_invoke_t m_invoke;
+			alignas( std::max_align_t ) unsigned char m_data[pool_task_size];
+		};
+
+		struct pool_completion_t {
+			uint64_t m_id;
+			bool m_succeeded;
+			bool m_is_stop;
+			alignas( std::max_align_t ) unsigned char m_result[pool_result_size];
+		};
+
+		template<typename Call, typename Ret>
+		void invoke_pool_task( void const *data, void *result ) {
+			auto const &call = *std::launder( reinterpret_cast<Call const *>( data ) );
+			if constexpr( std::is_void_v<Ret> ) {
+				(void)result;
+				call( );
+			} else {
+				Ret const value = call( );
+				memcpy( result, &value, sizeof( Ret ) );
+			}
+		}
+
+		struct pool_pending_base {
+			virtual ~pool_pending_base( ) = default;
+			virtual void complete( pool_completion_t const &c ) = 0;
+			virtual void fail( char const *what ) = 0;
+		};
+
+		template<typename Ret>
+		struct pool_pending final : pool_pending_base {
+			std::promise<Ret> m_promise{};
+
+			void fail( char const *what ) override {
+				m_promise.set_exception(
+				  std::make_exception_ptr( std::runtime_error( what ) ) );
+			}
+
+			void complete( pool_completion_t const &c ) override {
+				if( !c.m_succeeded ) {
+					fail( "Error running callable" );
+					return;
+				}
+				if constexpr( std::is_void_v<Ret> ) {
+					m_promise.set_value( );
+				} else {
+					Ret result;
+					memcpy( &result, c.m_result, sizeof( Ret ) );
+					m_promise.set_value( result );
+				}
+			}
+		};
+	} // namespace impl
+
+	// A set of worker processes, forked once when the pool is created, that
+	// run callables sent to them over shared memory queues.  The callable and
+	// its arguments are copied bytewise to the workers so they must be
+	// trivially copyable.  Pointers captured by them see the memory as it was
+	// when the pool was created.  A worker that dies fails the future of the
+	// task it was running and the pool carries on with the others.  Once no
+	// worker is left the outstanding futures fail and async throws
+	class process_pool {
+		using task_queue_t =
+		  daw::process::mpmc_channel<impl::pool_task_t, impl::pool_queue_size>;
+		using completion_queue_t =
+		  daw::process::mpmc_channel<impl::pool_completion_t,
+		                             impl::pool_queue_size>;
+
+		task_queue_t m_tasks{};
+		completion_queue_t m_completions{};
+		// Per worker, one more than the id of the task it runs or 0 when idle
+		std::vector<shared_memory<std::atomic<uint64_t>>> m_running{};
+		std::mutex m_pending_mutex{};
+		std::condition_variable m_worker_exited{};
+		std::unordered_map<uint64_t, std::unique_ptr<impl::pool_pending_base>>
+		  m_pending{};
+		size_t m_live_workers = 0;
+		bool m_is_stopping = false;
+		std::atomic<uint64_t> m_next_id = 0;
+		std::thread m_collector{};
+
+		static void run_worker( task_queue_t tasks, completion_queue_t completions,
+		                        std::atomic<uint64_t> &running ) noexcept {
+			while( true ) {
+				auto const task = tasks.read( );
+				if( !task.m_invoke ) {
+					return;
+				}
+				running.store( task.m_id + 1, std::memory_order_seq_cst );
+				auto completion = impl::pool_completion_t{};
+				completion.m_id = task.m_id;
+				try {
+					task.m_invoke( task.m_data, completion.m_result );
+					completion.m_succeeded = true;
+				} catch( ... ) { completion.m_succeeded = false; }
+				completions.write( completion );
+				running.store( 0, std::memory_order_seq_cst );
+			}
+		}
+
+		// Called on the reaper's thread.  A worker that exits other than through
+		// a stop task fails the future of the task it was running
+		void on_worker_exit( size_t worker ) {
+			auto const running =
+			  m_running[worker].data( )->exchange( 0, std::memory_order_seq_cst );
+			auto failed = std::vector<std::unique_ptr<impl::pool_pending_base>>( );
+			{
+				auto const lck = std::lock_guard( m_pending_mutex );
+				if( running != 0 ) {
+					// Skipped if the collector got its completion first
+					if( auto pos = m_pending.find( running - 1 );
+					    pos != m_pending.end( ) ) {
+						failed.push_back( std::move( pos->second ) );
+						m_pending.erase( pos );
+					}
+				}
+				--m_live_workers;
+				if( m_live_workers == 0 and !m_is_stopping ) {
+					// Nothing is left to run the queued tasks
+					for( auto &pending : m_pending ) {
+						failed.push_back( std::move( pending.second ) );
+					}
+					m_pending.clear( );
+				}
+				m_worker_exited.notify_all( );
+			}
+			for( auto &pending : failed ) {
+				pending->fail( "Worker process exited before finishing the callable" );
+			}
+		}
+
+		void run_collector( ) {
+			while( true ) {
+				auto const completion = m_completions.read( );
+				if( completion.m_is_stop ) {
+					return;
+				}
+				auto pending = std::unique_ptr<impl::pool_pending_base>( );
+				{
+					auto const lck = std::lock_guard( m_pending_mutex );
+					auto pos = m_pending.find( completion.m_id );
+					if( pos == m_pending.end( ) ) {
+						// Already failed when its worker exited
+						continue;
+					}
+					pending = std::move( pos->second );
+					m_pending.erase( pos );
+				}
+				pending->complete( completion );
+			}
+		}
+
+	public:
+		explicit process_pool(
+		  size_t worker_count = std::thread::hardware_concurrency( ) ) {
+			if( worker_count == 0 ) {
+				worker_count = 1;
+			}
+			m_running.resize( worker_count );
+			auto workers = std::vector<::pid_t>( );
+			workers.reserve( worker_count );
+			for( size_t n = 0; n < worker_count; ++n ) {
+				auto worker = fork_process<false>( &run_worker, m_tasks, m_completions,
+				                                   *m_running[n].data( ) );
+				workers.push_back( worker.native_handle( ) );
+			}
+			m_live_workers = worker_count;
+			// Workers are forked before the pool starts any threads
+			m_collector = std::thread( [this] { run_collector( ); } );
+			for( size_t n = 0; n < worker_count; ++n ) {
+				process_reaper::get( ).watch(
+				  workers[n], [this, n]( int ) { on_worker_exit( n ); } );
+			}
+		}
+
+		process_pool( process_pool const & ) = delete;
+		process_pool &operator=( process_pool const & ) = delete;
+		process_pool( process_pool && ) = delete;
+		process_pool &operator=( process_pool && ) = delete;
+
+		~process_pool( ) noexcept {
+			{
+				auto const lck = std::lock_guard( m_pending_mutex );
+				m_is_stopping = true;
+			}
+			// Queued tasks are run before the workers see the stop tasks
+			for( size_t n = 0; n < m_running.size( ); ++n ) {
+				m_tasks.write( impl::pool_task_t{} );
+			}
+			{
+				auto lck = std::unique_lock( m_pending_mutex );
+				m_worker_exited.wait( lck, [&] { return m_live_workers == 0; } );
+			}
+			auto stop = impl::pool_completion_t{};
+			stop.m_is_stop = true;
+			m_completions.write( stop );
+			m_collector.join( );
+		}
+
+		// The number of workers the pool was created with
+		size_t size( ) const noexcept {
+			return m_running.size( );
+		}
+
+		template<typename Function, typename... Arguments,
+		         typename Ret = std::remove_cv_t<std::remove_reference_t<
+		           std::invoke_result_t<Function, Arguments...>>>>
+		std::future<Ret> async( Function &&func, Arguments &&... arguments ) {
+			auto call = [f = std::forward<Function>( func ), arguments...]( ) -> Ret {
+				return std::invoke( f, arguments... );
+			};
+			using call_t = decltype( call );
+			static_assert( std::is_trivially_copyable_v<call_t>,
+			               "Callable and arguments must be trivially copyable" );
+			static_assert( sizeof( call_t ) <= impl::pool_task_size,
+			               "Callable and arguments are too large" );
+			static_assert( alignof( call_t ) <= alignof( std::max_align_t ) );
+			if constexpr( !std::is_void_v<Ret> ) {
+				static_assert( std::is_trivially_copyable_v<Ret> );
+				static_assert( std::is_default_constructible_v<Ret> );
+				static_assert( sizeof( Ret ) <= impl::pool_result_size,
+				               "Result is too large" );
+			}
+
+			auto task = impl::pool_task_t{};
+			task.m_id = m_next_id.fetch_add( 1, std::memory_order_relaxed );
+			task.m_invoke = &impl::invoke_pool_task<call_t, Ret>;
+			memcpy( task.m_data, &call, sizeof( call_t ) );
+
+			auto pending = std::make_unique<impl::pool_pending<Ret>>( );
+			auto result = pending->m_promise.get_future( );
+			{
+				auto const lck = std::lock_guard( m_pending_mutex );
+				daw::exception::daw_throw_on_true<std::runtime_error>(
+				  m_live_workers == 0, "No worker processes left in the pool" );
+				m_pending.emplace( task.m_id, std::move( pending ) );
+			}
+			m_tasks.write( task );
+			return result;
+		}
+	};
+} // namespace daw::process
@@ -0,0 +1,177 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined( __linux__ )
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#endif
+
+namespace daw::process {
+	namespace impl {
+		struct reaper_entry_base {
+			::pid_t m_pid;
+
+			explicit reaper_entry_base( ::pid_t pid ) noexcept
+			  : m_pid( pid ) {}
+
+			virtual ~reaper_entry_base( ) = default;
+			virtual void on_exit( int status ) = 0;
+		};
+
+		template<typename Function>
+		struct reaper_entry final : reaper_entry_base {
+			Function m_func;
+
+			template<typename F>
+			reaper_entry( ::pid_t pid, F &&func )
+			  : reaper_entry_base( pid )
+			  , m_func( std::forward<F>( func ) ) {}
+
+			void on_exit( int status ) override {
+				m_func( status );
+			}
+		};
+
+		inline void wait_and_notify( reaper_entry_base &entry ) {
+			int status = 0;
+			while( waitpid( entry.m_pid, &status, 0 ) < 0 and errno == EINTR ) {}
+			entry.on_exit( status );
+		}
+	} // namespace impl
+
+	// Waits on any number of child processes with a single thread.  Each child
+	// is tracked through a pidfd in an epoll set and reaped when it becomes
+	// readable.  Where pidfds are not available, a thread per child is used
+	class process_reaper {
+		std::mutex m_mutex{};
+		std::unordered_map<int, std::unique_ptr<impl::reaper_entry_base>>
+		  m_entries{};
+		::pid_t m_owner = getpid( );
+		int m_epoll = -1;
+
+		process_reaper( ) {
+#if defined( __linux__ )
+			m_epoll = epoll_create1( EPOLL_CLOEXEC );
+			if( m_epoll >= 0 ) {
+				std::thread( [this] { run( ); } ).detach( );
+			}
+#endif
+		}
+
+		void run( ) {
+#if defined( __linux__ )
+			auto events = std::array<epoll_event, 64>{};
+			while( true ) {
+				auto const count = epoll_wait( m_epoll, events.data( ),
+				                               static_cast<int>( events.size( ) ), -1 );
+				for( int n = 0; n < count; ++n ) {
+					auto const fd = events[static_cast<size_t>( n )].data.fd;
+					auto entry = std::unique_ptr<impl::reaper_entry_base>( );
+					{
+						auto const lck = std::lock_guard( m_mutex );
+						auto pos = m_entries.find( fd );
+						if( pos == m_entries.end( ) ) {
+							continue;
+						}
+						entry = std::move( pos->second );
+						m_entries.erase( pos );
+					}
+					epoll_ctl( m_epoll, EPOLL_CTL_DEL, fd, nullptr );
+					close( fd );
+					impl::wait_and_notify( *entry );
+				}
+			}
+#endif
+		}
+
+		bool try_watch( std::unique_ptr<impl::reaper_entry_base> &entry ) {
+#if defined( __linux__ ) and defined( SYS_pidfd_open )
+			if( m_epoll < 0 ) {
+				return false;
+			}
+			auto const fd = static_cast<int>(
+			  syscall( SYS_pidfd_open, entry->m_pid, 0U ) );
+			if( fd < 0 ) {
+				return false;
+			}
+			auto ev = epoll_event{};
+			ev.events = EPOLLIN;
+			ev.data.fd = fd;
+			auto const lck = std::lock_guard( m_mutex );
+			if( epoll_ctl( m_epoll, EPOLL_CTL_ADD, fd, &ev ) != 0 ) {
+				close( fd );
+				return false;
+			}
+			m_entries.emplace( fd, std::move( entry ) );
+			return true;
+#else
+			(void)entry;
+			return false;
+#endif
+		}
+
+	public:
+		process_reaper( process_reaper const & ) = delete;
+		process_reaper &operator=( process_reaper const & ) = delete;
+
+		// The reaper thread does not exist in a forked child, so each process
+		// gets its own instance.  They live until the process exits
+		static process_reaper &get( ) {
+			static std::mutex s_mutex{};
+			static process_reaper *s_reaper = nullptr;
+			auto const lck = std::lock_guard( s_mutex );
+			if( !s_reaper or s_reaper->m_owner != getpid( ) ) {
+				s_reaper = new process_reaper( );
+			}
+			return *s_reaper;
+		}
+
+		// Call func( status ) on the reaper's thread, with the status from
+		// waitpid, once the child pid has exited
+		template<typename Function>
+		void watch( ::pid_t pid, Function &&func ) {
+			static_assert( std::is_invocable_v<Function, int> );
+			auto entry = std::unique_ptr<impl::reaper_entry_base>(
+			  std::make_unique<impl::reaper_entry<std::decay_t<Function>>>(
+			    pid, std::forward<Function>( func ) ) );
+			if( !try_watch( entry ) ) {
+				std::thread( [e = std::move( entry )] {
+					impl::wait_and_notify( *e );
+				} ).detach( );
+			}
+		}
+	};
+} // namespace daw::process
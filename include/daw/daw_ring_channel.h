@@ -0,0 +1,215 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+#include "daw_metrics.h"
+#include "daw_pollable.h"
+#include "daw_semaphore.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		template<typename T, size_t Capacity>
+		struct ring_t {
+			// Owned by the reader
+			alignas( cache_line_size ) std::atomic<size_t> m_head;
+			size_t m_tail_cache;
+			// Owned by the writer
+			alignas( cache_line_size ) std::atomic<size_t> m_tail;
+			size_t m_head_cache;
+			// Set by a side that is about to block
+			alignas( cache_line_size ) std::atomic<bool> m_writer_waiting;
+			std::atomic<bool> m_reader_waiting;
+			alignas( cache_line_size ) std::array<T, Capacity> m_values;
+		};
+	} // namespace impl
+
+	// A single producer/single consumer channel that can hold up to Capacity
+	// values.  Reads and writes only touch the semaphores when the ring is empty
+	// or full respectively.  With Poll set to pollable, poll_handle( ) becomes
+	// readable when a write finds the ring empty
+	template<typename T, size_t Capacity = 64, typename Metrics = no_metrics,
+	         typename Poll = not_pollable>
+	class ring_channel : private Metrics, private Poll {
+		static_assert( std::is_trivially_copyable_v<T> );
+		static_assert( std::is_default_constructible_v<T> );
+		static_assert( Capacity > 0 );
+
+		using ring_t = impl::ring_t<T, Capacity>;
+
+		daw::process::semaphore m_can_write{};
+		daw::process::semaphore m_can_read{};
+		daw::process::shared_memory<ring_t> m_ring{};
+
+		bool push( T const &value ) noexcept {
+			ring_t &ring = *m_ring.data( );
+			auto const tail = ring.m_tail.load( std::memory_order_relaxed );
+			if( tail - ring.m_head_cache == Capacity ) {
+				ring.m_head_cache = ring.m_head.load( std::memory_order_seq_cst );
+				if( tail - ring.m_head_cache == Capacity ) {
+					return false;
+				}
+			}
+			ring.m_values[tail % Capacity] = value;
+			ring.m_tail.store( tail + 1, std::memory_order_seq_cst );
+			// Only the write into an empty ring makes the poll handle readable,
+			// a reader that saw the ring empty cannot miss it
+			if constexpr( Poll::is_enabled ) {
+				if( ring.m_head.load( std::memory_order_seq_cst ) == tail ) {
+					this->notify_poll_handle( );
+				}
+			}
+			if( ring.m_reader_waiting.exchange( false, std::memory_order_seq_cst ) ) {
+				m_can_read.post( );
+			}
+			return true;
+		}
+
+		std::optional<T> pop( ) noexcept {
+			ring_t &ring = *m_ring.data( );
+			auto const head = ring.m_head.load( std::memory_order_relaxed );
+			if( head == ring.m_tail_cache ) {
+				ring.m_tail_cache = ring.m_tail.load( std::memory_order_seq_cst );
+				if( head == ring.m_tail_cache ) {
+					return std::nullopt;
+				}
+			}
+			T result = ring.m_values[head % Capacity];
+			ring.m_head.store( head + 1, std::memory_order_seq_cst );
+			if( ring.m_writer_waiting.exchange( false, std::memory_order_seq_cst ) ) {
+				m_can_write.post( );
+			}
+			return result;
+		}
+
+		void wait_to_write( T const &value ) noexcept {
+			while( !push( value ) ) {
+				// Announce that we are waiting and check again so that a read between
+				// the failed push and the announcement is not missed
+				m_ring.data( )->m_writer_waiting.store( true,
+				                                        std::memory_order_seq_cst );
+				if( push( value ) ) {
+					if( !m_ring.data( )->m_writer_waiting.exchange( false ) ) {
+						// The reader saw our flag and has posted, consume it
+						m_can_write.wait( );
+					}
+					return;
+				}
+				m_can_write.wait( );
+			}
+		}
+
+		T wait_to_read( ) noexcept {
+			auto result = pop( );
+			while( !result ) {
+				m_ring.data( )->m_reader_waiting.store( true,
+				                                        std::memory_order_seq_cst );
+				if( result = pop( ); result ) {
+					if( !m_ring.data( )->m_reader_waiting.exchange( false ) ) {
+						// The writer saw our flag and has posted, consume it
+						m_can_read.wait( );
+					}
+					break;
+				}
+				m_can_read.wait( );
+				result = pop( );
+			}
+			return *result;
+		}
+
+	public:
+		ring_channel( ) noexcept(
+		  std::is_nothrow_default_constructible_v<Poll> ) = default;
+
+		explicit ring_channel( shared_memory_options const &opts ) noexcept(
+		  std::is_nothrow_default_constructible_v<Poll> )
+		  : m_ring( opts ) {}
+
+		static constexpr size_t capacity( ) noexcept {
+			return Capacity;
+		}
+
+		// True when a read would not wait
+		bool is_readable( ) noexcept {
+			auto const &ring = *m_ring.data( );
+			return ring.m_head.load( std::memory_order_relaxed ) !=
+			       ring.m_tail.load( std::memory_order_seq_cst );
+		}
+
+		// The pollable fd, or -1 when Poll is not_pollable
+		int poll_handle( ) const noexcept {
+			return Poll::poll_handle( );
+		}
+
+		void drain_poll_handle( ) noexcept {
+			Poll::drain_poll_handle( );
+		}
+
+		void write( T const &value ) noexcept {
+			this->acquire(
+			  metrics_side::write, [&] { return push( value ); },
+			  [&] { wait_to_write( value ); } );
+			this->record_message( sizeof( T ) );
+		}
+
+		bool try_write( T const &value ) noexcept {
+			if( push( value ) ) {
+				this->record_acquired( metrics_side::write );
+				this->record_message( sizeof( T ) );
+				return true;
+			}
+			return false;
+		}
+
+		T read( ) noexcept {
+			auto result = std::optional<T>( );
+			this->acquire(
+			  metrics_side::read,
+			  [&] {
+				  result = pop( );
+				  return result.has_value( );
+			  },
+			  [&] { result = wait_to_read( ); } );
+			return *result;
+		}
+
+		std::optional<T> try_read( ) noexcept {
+			auto result = pop( );
+			if( result ) {
+				this->record_acquired( metrics_side::read );
+			}
+			return result;
+		}
+
+		// Counters of this channel, all zero unless Metrics is shared_metrics
+		metrics_snapshot metrics( ) const noexcept {
+			return Metrics::snapshot( );
+		}
+	};
+} // namespace daw::process
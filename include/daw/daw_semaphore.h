@@ -22,82 +22,110 @@
 
 #pragma once
 
-#include <fcntl.h>
-#include <semaphore.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
 
-#include <daw/daw_exception.h>
-#include <daw/daw_random.h>
+#include "daw_await_fwd.h"
+#include "daw_futex.h"
+#include "daw_shared_memory.h"
 
 namespace daw::process {
+	namespace impl {
+		struct semaphore_state {
+			std::atomic<uint32_t> m_count;
+			std::atomic<uint32_t> m_waiters;
+		};
+	} // namespace impl
+
+	// A counting semaphore in anonymous or named shared memory.  post and
+	// try_wait never enter the kernel unless there is a waiter, wait spins
+	// briefly before parking on a futex
 	class semaphore {
-		sem_t *m_sem;
-		bool m_is_copy = false;
-
-		static sem_t *get_sem( int init_value ) noexcept {
-			auto const name = std::to_string( daw::randint<size_t>( ) );
-			auto result =
-			  sem_open( name.c_str( ), O_CREAT | O_EXCL, 0600, init_value );
-			if( result == SEM_FAILED ) {
-				return nullptr;
-			}
-			return result;
-		}
+		daw::process::shared_memory<impl::semaphore_state> m_state{};
 
-		void cleanup( ) noexcept {
-			if( !std::exchange( m_is_copy, true ) ) {
-				if( auto tmp_sem = std::exchange( m_sem, nullptr ); tmp_sem ) {
-					sem_close( tmp_sem );
-				}
-			}
+		impl::semaphore_state &state( ) noexcept {
+			return *m_state.data( );
 		}
 
 	public:
-		semaphore( ) noexcept
-		  : m_sem( get_sem( 0 ) ) {}
-
-		explicit semaphore( int initial_value ) noexcept
-		  : m_sem( get_sem( initial_value ) ) {}
+		semaphore( ) noexcept = default;
 
-		~semaphore( ) noexcept {
-			cleanup( );
+		explicit semaphore( int initial_value ) noexcept {
+			state( ).m_count.store( static_cast<uint32_t>( initial_value ),
+			                        std::memory_order_release );
 		}
 
-		semaphore( semaphore const &other ) noexcept
-		  : m_sem( other.m_sem )
-		  , m_is_copy( true ) {}
+		// initial_value is only used by the process that creates the semaphore
+		semaphore( open_or_create_t, std::string const &name,
+		           int initial_value = 0 )
+		  : m_state( open_or_create, name,
+		             [initial_value]( impl::semaphore_state &st ) {
+			             st.m_count.store( static_cast<uint32_t>( initial_value ),
+			                               std::memory_order_relaxed );
+		             } ) {}
+
+		static bool remove( std::string const &name ) noexcept {
+			return shared_memory<impl::semaphore_state>::remove( name );
+		}
 
-		semaphore &operator=( semaphore const &rhs ) noexcept {
-			if( this != &rhs ) {
-				cleanup( );
-				m_sem = rhs.m_sem;
+		void wait( ) {
+			for( size_t n = 0; n < impl::spin_count; ++n ) {
+				if( try_wait( ) ) {
+					return;
+				}
+				impl::cpu_relax( );
+			}
+			auto &st = state( );
+			st.m_waiters.fetch_add( 1, std::memory_order_seq_cst );
+			while( !try_wait( ) ) {
+				impl::futex_wait( &st.m_count, 0 );
 			}
-			return *this;
+			st.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
 		}
 
-		semaphore( semaphore &&other ) noexcept
-		  : m_sem( std::exchange( other.m_sem, nullptr ) )
-		  , m_is_copy( std::exchange( other.m_is_copy, true ) ) {}
+		bool try_wait( ) noexcept {
+			auto &count = state( ).m_count;
+			auto current = count.load( std::memory_order_relaxed );
+			while( current > 0 ) {
+				if( count.compare_exchange_weak( current, current - 1,
+				                                 std::memory_order_seq_cst,
+				                                 std::memory_order_relaxed ) ) {
+					return true;
+				}
+			}
+			return false;
+		}
 
-		semaphore &operator=( semaphore &&rhs ) noexcept {
-			if( this != &rhs ) {
-				cleanup( );
-				m_sem = std::exchange( rhs.m_sem, nullptr );
-				m_is_copy = std::exchange( rhs.m_is_copy, true );
+		void post( ) noexcept {
+			auto &st = state( );
+			st.m_count.fetch_add( 1, std::memory_order_seq_cst );
+			if( st.m_waiters.load( std::memory_order_seq_cst ) > 0 ) {
+				impl::futex_wake( &st.m_count, 1 );
 			}
-			return *this;
 		}
 
-		void wait( ) {
-			daw::exception::daw_throw_on_true<std::runtime_error>(
-			  sem_wait( m_sem ) == -1, "Error waiting for data" );
+		// The current count, a snapshot that other processes may change
+		uint32_t value( ) noexcept {
+			return state( ).m_count.load( std::memory_order_acquire );
 		}
 
-		bool try_wait( ) noexcept {
-			return sem_trywait( m_sem ) == 0;
+		impl::semaphore_state *native_handle( ) noexcept {
+			return &state( );
 		}
 
-		void post( ) noexcept {
-			sem_post( m_sem );
+#if defined( DAW_PROCESS_HAS_COROUTINES )
+		// co_await sem.async_wait( ) waits without blocking the thread, the
+		// coroutine is resumed through executor.  The default, inline_executor,
+		// resumes it on a service thread of the library and not on the thread
+		// that awaited.  Needs daw_await.h
+		template<typename Executor = inline_executor>
+		auto async_wait( Executor executor = Executor{} ) {
+			auto &st = state( );
+			return semaphore_awaitable( &st.m_count, &st.m_waiters,
+			                            [this] { return try_wait( ); },
+			                            std::move( executor ) );
 		}
+#endif
 	};
 } // namespace daw::process
@@ -0,0 +1,287 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <daw/daw_exception.h>
+
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	// A pointer stored as the distance from itself, so that it remains valid
+	// when the memory holding it is mapped at another address
+	template<typename T>
+	class offset_ptr {
+		// 1 is never a valid distance to a T from here and is used for null
+		std::ptrdiff_t m_offset = 1;
+
+		std::ptrdiff_t offset_to( T const *ptr ) const noexcept {
+			if( !ptr ) {
+				return 1;
+			}
+			return reinterpret_cast<char const *>( ptr ) -
+			       reinterpret_cast<char const *>( this );
+		}
+
+	public:
+		offset_ptr( ) noexcept = default;
+
+		offset_ptr( std::nullptr_t ) noexcept {}
+
+		offset_ptr( T *ptr ) noexcept
+		  : m_offset( offset_to( ptr ) ) {}
+
+		offset_ptr( offset_ptr const &other ) noexcept
+		  : m_offset( offset_to( other.get( ) ) ) {}
+
+		offset_ptr &operator=( offset_ptr const &rhs ) noexcept {
+			m_offset = offset_to( rhs.get( ) );
+			return *this;
+		}
+
+		offset_ptr &operator=( T *ptr ) noexcept {
+			m_offset = offset_to( ptr );
+			return *this;
+		}
+
+		T *get( ) const noexcept {
+			if( m_offset == 1 ) {
+				return nullptr;
+			}
+			return reinterpret_cast<T *>(
+			  const_cast<char *>( reinterpret_cast<char const *>( this ) ) +
+			  m_offset );
+		}
+
+		T &operator*( ) const noexcept {
+			return *get( );
+		}
+
+		T *operator->( ) const noexcept {
+			return get( );
+		}
+
+		explicit operator bool( ) const noexcept {
+			return m_offset != 1;
+		}
+	};
+
+	namespace impl {
+		// Size classes are the powers of two from 16 bytes to 1MiB.  Larger
+		// allocations come straight from the bump pointer and are not reused
+		inline constexpr size_t arena_min_class_shift = 4;
+		inline constexpr size_t arena_max_class_shift = 20;
+		inline constexpr size_t arena_class_count =
+		  arena_max_class_shift - arena_min_class_shift + 1;
+		inline constexpr size_t arena_page_size = 4096;
+
+		// Free list heads pack a 40 bit offset with a 24 bit tag that changes on
+		// every pop so that a stale head cannot be swapped back in
+		inline constexpr uint64_t arena_offset_mask = ( uint64_t{1} << 40U ) - 1U;
+		inline constexpr uint64_t arena_tag_one = uint64_t{1} << 40U;
+
+		struct arena_header_t {
+			alignas( cache_line_size ) std::atomic<uint64_t> m_next;
+			uint64_t m_capacity;
+			alignas( cache_line_size )
+			  std::array<std::atomic<uint64_t>, arena_class_count> m_free_lists;
+		};
+
+		constexpr size_t arena_class_index( size_t bytes,
+		                                    size_t alignment ) noexcept {
+			auto const needed = bytes > alignment ? bytes : alignment;
+			size_t shift = arena_min_class_shift;
+			while( ( size_t{1} << shift ) < needed ) {
+				++shift;
+			}
+			return shift - arena_min_class_shift;
+		}
+
+		constexpr size_t arena_class_size( size_t idx ) noexcept {
+			return size_t{1} << ( idx + arena_min_class_shift );
+		}
+
+		constexpr uint64_t align_up( uint64_t value, uint64_t alignment ) noexcept {
+			return ( value + alignment - 1U ) & ~( alignment - 1U );
+		}
+	} // namespace impl
+
+	// A std::pmr::memory_resource that carves allocations out of one shared
+	// mapping.  Allocation is a lock free bump of an offset, freed blocks go on
+	// lock free per size class lists and are reused.  Memory allocated before
+	// or after a fork is visible to the parent and children.  Containers
+	// placed in the arena refer to this object, so use them from processes
+	// forked from the one that created it
+	class shared_arena : public std::pmr::memory_resource {
+		impl::shared_region m_region;
+
+		impl::arena_header_t &header( ) const noexcept {
+			return *std::launder(
+			  reinterpret_cast<impl::arena_header_t *>( m_region.data( ) ) );
+		}
+
+		char *base( ) const noexcept {
+			return static_cast<char *>( m_region.data( ) );
+		}
+
+		void *bump( size_t bytes, size_t alignment ) {
+			auto &hdr = header( );
+			auto current = hdr.m_next.load( std::memory_order_relaxed );
+			uint64_t first = 0;
+			do {
+				first = impl::align_up( current, alignment );
+				if( first + bytes > hdr.m_capacity ) {
+					throw std::bad_alloc( );
+				}
+			} while( !hdr.m_next.compare_exchange_weak(
+			  current, first + bytes, std::memory_order_relaxed ) );
+			return base( ) + first;
+		}
+
+		std::atomic<uint64_t> &next_free( uint64_t offset ) const noexcept {
+			return *std::launder(
+			  reinterpret_cast<std::atomic<uint64_t> *>( base( ) + offset ) );
+		}
+
+		void *pop( size_t idx ) noexcept {
+			auto &head = header( ).m_free_lists[idx];
+			auto current = head.load( std::memory_order_acquire );
+			while( ( current & impl::arena_offset_mask ) != 0 ) {
+				auto const offset = current & impl::arena_offset_mask;
+				// The block may be popped and reused under us, the tag makes the
+				// exchange fail if so
+				auto const next =
+				  next_free( offset ).load( std::memory_order_relaxed );
+				auto const tag =
+				  ( current & ~impl::arena_offset_mask ) + impl::arena_tag_one;
+				if( head.compare_exchange_weak( current, tag | next,
+				                                std::memory_order_acquire,
+				                                std::memory_order_acquire ) ) {
+					return base( ) + offset;
+				}
+			}
+			return nullptr;
+		}
+
+		void push( size_t idx, void *ptr ) noexcept {
+			auto &head = header( ).m_free_lists[idx];
+			auto const offset =
+			  static_cast<uint64_t>( static_cast<char *>( ptr ) - base( ) );
+			auto current = head.load( std::memory_order_relaxed );
+			do {
+				next_free( offset ).store( current & impl::arena_offset_mask,
+				                           std::memory_order_relaxed );
+			} while( !head.compare_exchange_weak(
+			  current, ( current & ~impl::arena_offset_mask ) | offset,
+			  std::memory_order_release, std::memory_order_relaxed ) );
+		}
+
+	protected:
+		void *do_allocate( size_t bytes, size_t alignment ) override {
+			auto const idx = impl::arena_class_index( bytes, alignment );
+			if( idx >= impl::arena_class_count ) {
+				return bump( bytes, std::max( alignment, impl::arena_page_size ) );
+			}
+			if( auto result = pop( idx ); result ) {
+				return result;
+			}
+			// Blocks are aligned to their size, up to a page, so that any block in
+			// a class satisfies any request that maps to it
+			auto const size = impl::arena_class_size( idx );
+			return bump( size, std::min( size, impl::arena_page_size ) );
+		}
+
+		void do_deallocate( void *ptr, size_t bytes,
+		                    size_t alignment ) override {
+			auto const idx = impl::arena_class_index( bytes, alignment );
+			if( idx < impl::arena_class_count ) {
+				push( idx, ptr );
+			}
+		}
+
+		bool do_is_equal(
+		  std::pmr::memory_resource const &other ) const noexcept override {
+			return this == &other;
+		}
+
+	public:
+		explicit shared_arena( size_t capacity,
+		                       shared_memory_options const &opts = {} )
+		  : m_region( sizeof( impl::arena_header_t ) + capacity, opts ) {
+
+			daw::exception::daw_throw_on_false<std::runtime_error>(
+			  m_region.data( ), "Error mapping shared_arena" );
+			auto *hdr = new( m_region.data( ) ) impl::arena_header_t;
+			hdr->m_capacity = m_region.size( );
+			hdr->m_next.store( sizeof( impl::arena_header_t ),
+			                   std::memory_order_release );
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  hdr->m_capacity > impl::arena_offset_mask, "shared_arena too large" );
+		}
+
+		shared_arena( shared_arena const & ) = delete;
+		shared_arena &operator=( shared_arena const & ) = delete;
+		shared_arena( shared_arena && ) = delete;
+		shared_arena &operator=( shared_arena && ) = delete;
+		~shared_arena( ) override = default;
+
+		size_t capacity( ) const noexcept {
+			return static_cast<size_t>( header( ).m_capacity );
+		}
+
+		// Bytes taken from the bump pointer so far, freed blocks included
+		size_t used( ) const noexcept {
+			return static_cast<size_t>(
+			  header( ).m_next.load( std::memory_order_relaxed ) );
+		}
+
+		bool contains( void const *ptr ) const noexcept {
+			auto const p = static_cast<char const *>( ptr );
+			return p >= base( ) and p < base( ) + capacity( );
+		}
+
+		// Construct a T in the arena, e.g. a std::pmr::vector that uses the arena
+		// for its elements too
+		template<typename T, typename... Args>
+		T *make( Args &&... args ) {
+			auto *mem = allocate( sizeof( T ), alignof( T ) );
+			return new( mem ) T( std::forward<Args>( args )... );
+		}
+
+		template<typename T>
+		void destroy( T *ptr ) {
+			ptr->~T( );
+			deallocate( ptr, sizeof( T ), alignof( T ) );
+		}
+	};
+} // namespace daw::process
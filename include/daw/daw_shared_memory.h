@@ -22,40 +22,604 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sched.h>
+#include <signal.h>
+#include <stdexcept>
+#include <string>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <type_traits>
+#include <unistd.h>
 #include <utility>
 
+#if __cplusplus > 201703L and __has_include( <span> )
+#include <span>
+#endif
+
+#if defined( __linux__ )
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include <daw/daw_exception.h>
+#if not defined( __linux__ )
+#include <daw/daw_random.h>
+#endif
+
+#include "daw_futex.h"
+
 namespace daw::process {
+	// A view of values in shared memory
+	template<typename T>
+	class buffer_span {
+		T *m_first = nullptr;
+		size_t m_size = 0;
+
+	public:
+		using value_type = std::remove_cv_t<T>;
+		using pointer = T *;
+		using iterator = T *;
+
+		constexpr buffer_span( ) noexcept = default;
+
+		constexpr buffer_span( T *first, size_t size ) noexcept
+		  : m_first( first )
+		  , m_size( size ) {}
+
+		constexpr pointer data( ) const noexcept {
+			return m_first;
+		}
+
+		constexpr size_t size( ) const noexcept {
+			return m_size;
+		}
+
+		constexpr bool empty( ) const noexcept {
+			return m_size == 0;
+		}
+
+		constexpr iterator begin( ) const noexcept {
+			return m_first;
+		}
+
+		constexpr iterator end( ) const noexcept {
+			return m_first + m_size;
+		}
+
+		constexpr T &operator[]( size_t idx ) const noexcept {
+			return m_first[idx];
+		}
+
+#if defined( __cpp_lib_span )
+		constexpr operator std::span<T>( ) const noexcept {
+			return {m_first, m_size};
+		}
+#endif
+	};
+
+	enum class huge_pages {
+		// Regular pages
+		none,
+		// Ask for transparent huge pages with madvise( MADV_HUGEPAGE )
+		transparent,
+		// Map with MAP_HUGETLB, falling back to regular pages when no huge pages
+		// are reserved
+		hugetlb
+	};
+
+	// How a shared mapping is set up.  All of these are best effort, a mapping
+	// is still made if the system refuses one of them
+	struct shared_memory_options {
+		// Fault in all the pages up front instead of on first touch
+		bool populate = false;
+		huge_pages huge = huge_pages::none;
+		// mlock the pages so that they are never swapped out
+		bool lock = false;
+		// Bind the pages to this NUMA node, when non-negative
+		int numa_node = -1;
+	};
+
+	namespace impl {
+		// Used to keep members written by different processes from sharing a
+		// cache line
+		inline constexpr size_t cache_line_size = 64;
+		inline constexpr size_t huge_page_size = 2U * 1024U * 1024U;
+
+		struct mapping_t {
+			void *m_data = nullptr;
+			size_t m_size = 0;
+		};
+
+		inline void bind_to_node( void *data, size_t size, int node ) noexcept {
+#if defined( __linux__ ) and defined( SYS_mbind )
+			static constexpr size_t bits_per_word =
+			  sizeof( unsigned long ) * CHAR_BIT;
+			auto mask = std::array<unsigned long, 16>{};
+			auto const n = static_cast<size_t>( node );
+			if( n >= mask.size( ) * bits_per_word ) {
+				return;
+			}
+			mask[n / bits_per_word] = 1UL << ( n % bits_per_word );
+			(void)syscall( SYS_mbind, data, size, MPOL_BIND, mask.data( ),
+			               mask.size( ) * bits_per_word + 1U, 0U );
+#else
+			(void)data;
+			(void)size;
+			(void)node;
+#endif
+		}
+
+		inline void populate( void *data, size_t size ) noexcept {
+#if defined( MADV_POPULATE_WRITE )
+			if( madvise( data, size, MADV_POPULATE_WRITE ) == 0 ) {
+				return;
+			}
+#endif
+			auto const page_size = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+			auto ptr = static_cast<volatile char *>( data );
+			for( size_t n = 0; n < size; n += page_size ) {
+				ptr[n] = ptr[n];
+			}
+		}
+
+		// Set up the placement, population and locking of a fresh mapping
+		inline void apply_options( mapping_t const &mapping,
+		                           shared_memory_options const &opts,
+		                           bool is_populated ) noexcept {
+#if defined( MADV_HUGEPAGE )
+			if( opts.huge == huge_pages::transparent ) {
+				(void)madvise( mapping.m_data, mapping.m_size, MADV_HUGEPAGE );
+			}
+#endif
+			// Placement policy has to be set before the pages are faulted in
+			if( opts.numa_node >= 0 ) {
+				bind_to_node( mapping.m_data, mapping.m_size, opts.numa_node );
+			}
+			if( opts.populate and !is_populated ) {
+				populate( mapping.m_data, mapping.m_size );
+			}
+			if( opts.lock ) {
+				(void)mlock( mapping.m_data, mapping.m_size );
+			}
+		}
+
+		// Make an anonymous shared mapping of at least size bytes.  The returned
+		// size is what must be passed to munmap
+		inline mapping_t map_shared( size_t size,
+		                             shared_memory_options const &opts ) noexcept {
+			static constexpr int prot = PROT_READ | PROT_WRITE;
+			static constexpr int flags = MAP_SHARED | MAP_ANONYMOUS;
+			auto result = mapping_t{MAP_FAILED, size};
+#if defined( MAP_HUGETLB )
+			if( opts.huge == huge_pages::hugetlb ) {
+				result.m_size =
+				  ( ( size + huge_page_size - 1U ) / huge_page_size ) * huge_page_size;
+				result.m_data =
+				  mmap( nullptr, result.m_size, prot, flags | MAP_HUGETLB, -1, 0 );
+			}
+#endif
+			bool const can_populate_on_map =
+			  opts.huge != huge_pages::transparent and opts.numa_node < 0;
+			bool populated = false;
+			if( result.m_data == MAP_FAILED ) {
+				result.m_size = size;
+				int extra_flags = 0;
+#if defined( MAP_POPULATE )
+				if( opts.populate and can_populate_on_map ) {
+					extra_flags = MAP_POPULATE;
+					populated = true;
+				}
+#endif
+				result.m_data =
+				  mmap( nullptr, result.m_size, prot, flags | extra_flags, -1, 0 );
+				if( result.m_data == MAP_FAILED ) {
+					return mapping_t{};
+				}
+			}
+			apply_options( result, opts, populated );
+			return result;
+		}
+
+		// An anonymous file that can be grown with ftruncate and mapped by every
+		// process holding the fd
+		inline int create_memfd( char const *name ) noexcept {
+#if defined( __linux__ )
+			return memfd_create( name, MFD_CLOEXEC | MFD_ALLOW_SEALING );
+#else
+			(void)name;
+			auto const shm_name =
+			  "/daw_" + std::to_string( daw::randint<size_t>( ) );
+			auto const fd =
+			  shm_open( shm_name.c_str( ), O_CREAT | O_EXCL | O_RDWR, 0600 );
+			if( fd >= 0 ) {
+				shm_unlink( shm_name.c_str( ) );
+			}
+			return fd;
+#endif
+		}
+
+		inline size_t file_size( int fd ) noexcept {
+			struct stat st {};
+			if( fstat( fd, &st ) != 0 ) {
+				return 0;
+			}
+			return static_cast<size_t>( st.st_size );
+		}
+
+		// Grow the file to at least size bytes without ever shrinking it.  A
+		// file sealed with F_SEAL_SHRINK refuses to shrink when another process
+		// grew it further in the meantime
+		inline bool grow_file( int fd, size_t size ) noexcept {
+			while( file_size( fd ) < size ) {
+				if( ftruncate( fd, static_cast<off_t>( size ) ) == 0 ) {
+					return true;
+				}
+				if( errno != EPERM ) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// An anonymous shared mapping whose size is only known at runtime.  Like
+		// shared_memory, copies refer to the same mapping but do not own it
+		class shared_region {
+			void *m_data = nullptr;
+			size_t m_size = 0;
+			bool m_is_copy = false;
+
+			void cleanup( ) noexcept {
+				if( !std::exchange( m_is_copy, true ) ) {
+					if( auto tmp_data = std::exchange( m_data, nullptr ); tmp_data ) {
+						munmap( tmp_data, m_size );
+					}
+				}
+			}
+
+		public:
+			shared_region( ) noexcept = default;
+
+			explicit shared_region(
+			  size_t size, shared_memory_options const &opts = {} ) noexcept {
+				auto const mapping = map_shared( size, opts );
+				m_data = mapping.m_data;
+				m_size = mapping.m_size;
+			}
+
+			~shared_region( ) noexcept {
+				cleanup( );
+			}
+
+			shared_region( shared_region const &other ) noexcept
+			  : m_data( other.m_data )
+			  , m_size( other.m_size )
+			  , m_is_copy( true ) {}
+
+			shared_region &operator=( shared_region const &rhs ) noexcept {
+				if( this != &rhs ) {
+					cleanup( );
+					m_data = rhs.m_data;
+					m_size = rhs.m_size;
+				}
+				return *this;
+			}
+
+			shared_region( shared_region &&other ) noexcept
+			  : m_data( std::exchange( other.m_data, nullptr ) )
+			  , m_size( std::exchange( other.m_size, 0 ) )
+			  , m_is_copy( std::exchange( other.m_is_copy, true ) ) {}
+
+			shared_region &operator=( shared_region &&rhs ) noexcept {
+				if( this != &rhs ) {
+					cleanup( );
+					m_data = std::exchange( rhs.m_data, nullptr );
+					m_size = std::exchange( rhs.m_size, 0 );
+					m_is_copy = std::exchange( rhs.m_is_copy, true );
+				}
+				return *this;
+			}
+
+			void *data( ) const noexcept {
+				return m_data;
+			}
+
+			size_t size( ) const noexcept {
+				return m_size;
+			}
+		};
+	} // namespace impl
+
+	// Selects the constructors that attach to a named object, creating it if
+	// it does not exist yet.  Names follow shm_open, e.g. "/my_channel", and
+	// stay in place until removed
+	struct open_or_create_t {
+		explicit open_or_create_t( ) = default;
+	};
+	inline constexpr open_or_create_t open_or_create{};
+
+	// Selects the constructors that make an anonymous file whose fd, from
+	// native_handle( ), survives exec so that another program can attach
+	struct inheritable_t {
+		explicit inheritable_t( ) = default;
+	};
+	inline constexpr inheritable_t inheritable{};
+
+	// Selects the constructors that attach to an fd from an inheritable object
+	struct from_handle_t {
+		explicit from_handle_t( ) = default;
+	};
+	inline constexpr from_handle_t from_handle{};
+
+	namespace impl {
+		// Named and fd backed objects start with this header.  The creator
+		// constructs the value and then publishes it so that others never see a
+		// partially initialized one.  Its pid lets them tell when it died first
+		struct attach_header_t {
+			std::atomic<uint32_t> m_state;
+			std::atomic<::pid_t> m_creator;
+		};
+		inline constexpr size_t attach_header_size = cache_line_size;
+		inline constexpr uint32_t attach_ready = 1;
+		inline constexpr uint32_t attach_failed = 2;
+
+		// How long a creator may take to size a new object and record its pid.
+		// It does both right after creating it
+		inline constexpr auto attach_setup_timeout = std::chrono::seconds( 1 );
+		inline constexpr auto attach_poll_interval = timespec{0, 10'000'000};
+
+		// A child of this process that exited but was not reaped yet is gone too
+		inline bool is_process_gone( ::pid_t pid ) noexcept {
+			if( kill( pid, 0 ) != 0 ) {
+				return errno == ESRCH;
+			}
+			auto info = siginfo_t{};
+			return waitid( P_PID, static_cast<id_t>( pid ), &info,
+			               WEXITED | WNOHANG | WNOWAIT ) == 0 and
+			       info.si_pid == pid;
+		}
+
+		struct no_init {
+			template<typename T>
+			constexpr void operator( )( T const & ) const noexcept {}
+		};
+
+		inline mapping_t map_fd( int fd, size_t size,
+		                         shared_memory_options const &opts ) {
+			auto const result = mapping_t{
+			  mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ), size};
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  result.m_data == MAP_FAILED, "Error mapping shared memory" );
+			apply_options( result, opts, false );
+			return result;
+		}
+
+		// Throws if the creator did not size the file in time, e.g. because it
+		// died right after creating it
+		inline void wait_for_size( int fd, size_t size ) {
+			auto const deadline =
+			  std::chrono::steady_clock::now( ) + attach_setup_timeout;
+			while( file_size( fd ) < size ) {
+				daw::exception::daw_throw_on_true<std::runtime_error>(
+				  std::chrono::steady_clock::now( ) > deadline,
+				  "Timed out waiting for the creator of shared memory" );
+				sched_yield( );
+			}
+		}
+
+		struct attached_t {
+			int m_fd;
+			bool m_is_created;
+		};
+
+		inline attached_t open_or_create_shm( std::string const &name,
+		                                      size_t size ) {
+			while( true ) {
+				auto fd = shm_open( name.c_str( ), O_CREAT | O_EXCL | O_RDWR, 0600 );
+				if( fd >= 0 ) {
+					daw::exception::daw_throw_on_true<std::runtime_error>(
+					  ftruncate( fd, static_cast<off_t>( size ) ) != 0,
+					  "Error sizing shared memory" );
+					return {fd, true};
+				}
+				daw::exception::daw_throw_on_true<std::runtime_error>(
+				  errno != EEXIST, "Error creating shared memory" );
+				fd = shm_open( name.c_str( ), O_RDWR, 0 );
+				if( fd >= 0 ) {
+					try {
+						wait_for_size( fd, size );
+					} catch( ... ) {
+						close( fd );
+						throw;
+					}
+					return {fd, false};
+				}
+				// Removed between the two calls, try to create it again
+				daw::exception::daw_throw_on_true<std::runtime_error>(
+				  errno != ENOENT, "Error opening shared memory" );
+			}
+		}
+	} // namespace impl
+
 	template<typename T>
 	class shared_memory {
-		volatile char *m_data;
+		volatile char *m_data = nullptr;
+		size_t m_size = 0;
+		// Distance from the start of the mapping to the value
+		size_t m_offset = 0;
+		// Only set for inheritable objects
+		int m_fd = -1;
 		bool m_is_copy = false;
 
-		static_assert( std::is_trivially_copyable_v<T> );
+		// The mapping is released without running a destructor, T's like
+		// std::atomic that cannot be copied may still be placed here but can only
+		// be accessed via data( )
+		static_assert( std::is_trivially_destructible_v<T> );
 		static_assert( std::is_default_constructible_v<T> );
+		static_assert( alignof( T ) <= impl::attach_header_size );
 
 		void cleanup( ) noexcept {
 			if( !std::exchange( m_is_copy, true ) ) {
 				if( auto tmp_data = std::exchange( m_data, nullptr ); tmp_data ) {
 					auto ptr =
-					  const_cast<void *>( reinterpret_cast<volatile void *>( m_data ) );
-					munmap( ptr, sizeof( T ) );
+					  const_cast<void *>( reinterpret_cast<volatile void *>( tmp_data ) );
+					munmap( static_cast<char *>( ptr ) - m_offset, m_size );
+				}
+				if( auto tmp_fd = std::exchange( m_fd, -1 ); tmp_fd >= 0 ) {
+					close( tmp_fd );
+				}
+			}
+		}
+
+		template<typename OnCreate>
+		void attach( impl::mapping_t const &mapping, bool is_created,
+		             OnCreate &on_create ) {
+			m_size = mapping.m_size;
+			m_offset = impl::attach_header_size;
+			m_data = static_cast<volatile char *>( mapping.m_data ) + m_offset;
+			auto *header = std::launder(
+			  reinterpret_cast<impl::attach_header_t *>( mapping.m_data ) );
+			auto &state = header->m_state;
+			if( is_created ) {
+				header->m_creator.store( getpid( ), std::memory_order_release );
+				try {
+					new( raw_data( ) ) T;
+					on_create( *data( ) );
+				} catch( ... ) {
+					state.store( impl::attach_failed, std::memory_order_release );
+					impl::futex_wake_all( &state );
+					throw;
 				}
+				state.store( impl::attach_ready, std::memory_order_release );
+				impl::futex_wake_all( &state );
+			} else {
+				wait_until_ready( *header );
 			}
 		}
 
+		// Throws when the creator failed or exited before publishing the value.
+		// Such an object stays unusable until its name is removed
+		static void wait_until_ready( impl::attach_header_t &header ) {
+			auto const deadline =
+			  std::chrono::steady_clock::now( ) + impl::attach_setup_timeout;
+			auto &state = header.m_state;
+			while( true ) {
+				auto const current = state.load( std::memory_order_acquire );
+				if( current == impl::attach_ready ) {
+					return;
+				}
+				daw::exception::daw_throw_on_true<std::runtime_error>(
+				  current == impl::attach_failed,
+				  "Creator of shared memory failed to initialize it" );
+				auto const creator = header.m_creator.load( std::memory_order_acquire );
+				if( creator == 0 ) {
+					daw::exception::daw_throw_on_true<std::runtime_error>(
+					  std::chrono::steady_clock::now( ) > deadline,
+					  "Timed out waiting for the creator of shared memory" );
+				} else {
+					daw::exception::daw_throw_on_true<std::runtime_error>(
+					  impl::is_process_gone( creator ),
+					  "Creator of shared memory exited before initializing it" );
+				}
+				(void)impl::futex_wait_for( &state, current,
+				                            impl::attach_poll_interval );
+			}
+		}
+
+		static constexpr size_t attached_size( ) noexcept {
+			return impl::attach_header_size + sizeof( T );
+		}
+
 	public:
 		shared_memory( ) noexcept
-		  : m_data( static_cast<volatile char *>(
-		      mmap( nullptr, sizeof( T ), PROT_READ | PROT_WRITE,
-		            MAP_SHARED | MAP_ANONYMOUS, -1, 0 ) ) ) {}
+		  : shared_memory( shared_memory_options{} ) {}
+
+		explicit shared_memory( shared_memory_options const &opts ) noexcept {
+			auto const mapping = impl::map_shared( sizeof( T ), opts );
+			m_data = static_cast<volatile char *>( mapping.m_data );
+			m_size = mapping.m_size;
+			if( m_data ) {
+				new( raw_data( ) ) T;
+			}
+		}
+
+		// Attach to the object called name, if this creates it on_create( T & )
+		// is called before any other process can see the value
+		template<typename OnCreate = impl::no_init>
+		shared_memory( open_or_create_t, std::string const &name,
+		               OnCreate &&on_create = OnCreate{},
+		               shared_memory_options const &opts = {} ) {
+			auto const attached = impl::open_or_create_shm( name, attached_size( ) );
+			auto const mapping = [&] {
+				try {
+					return impl::map_fd( attached.m_fd, attached_size( ), opts );
+				} catch( ... ) {
+					close( attached.m_fd );
+					throw;
+				}
+			}( );
+			// The mapping keeps the object alive
+			close( attached.m_fd );
+			try {
+				attach( mapping, attached.m_is_created, on_create );
+			} catch( ... ) {
+				munmap( mapping.m_data, mapping.m_size );
+				if( attached.m_is_created ) {
+					// Let the next attempt create it again
+					remove( name );
+				}
+				throw;
+			}
+		}
+
+		template<typename OnCreate = impl::no_init>
+		explicit shared_memory( inheritable_t, OnCreate &&on_create = OnCreate{},
+		                        shared_memory_options const &opts = {} )
+		  : m_fd( impl::create_memfd( "daw_shared_memory" ) ) {
+
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  m_fd < 0, "Error creating shared memory" );
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  fcntl( m_fd, F_SETFD, 0 ) != 0 or
+			    ftruncate( m_fd, static_cast<off_t>( attached_size( ) ) ) != 0,
+			  "Error sizing shared memory" );
+			attach( impl::map_fd( m_fd, attached_size( ), opts ), true, on_create );
+		}
+
+		// Attach to the fd of an inheritable shared_memory, e.g. one that was
+		// passed to this program on exec.  The fd is not closed
+		shared_memory( from_handle_t, int fd,
+		               shared_memory_options const &opts = {} ) {
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  impl::file_size( fd ) < attached_size( ), "Invalid shared memory fd" );
+			auto on_create = impl::no_init{};
+			attach( impl::map_fd( fd, attached_size( ), opts ), false, on_create );
+		}
+
+		// Remove the name of a named object, processes attached to it keep it
+		static bool remove( std::string const &name ) noexcept {
+			return shm_unlink( name.c_str( ) ) == 0;
+		}
 
 		~shared_memory( ) noexcept {
 			cleanup( );
 		}
 
+		// The fd of an inheritable object, otherwise -1
+		int native_handle( ) const noexcept {
+			return m_fd;
+		}
+
 		void *raw_data( ) noexcept {
 			return const_cast<char *>( m_data );
 		}
@@ -65,32 +629,50 @@ namespace daw::process {
 			  reinterpret_cast<T *>( const_cast<char *>( m_data ) ) );
 		}
 
+		T const *data( ) const {
+			return std::launder(
+			  reinterpret_cast<T const *>( const_cast<char const *>( m_data ) ) );
+		}
+
 		shared_memory( shared_memory const &other ) noexcept
 		  : m_data( other.m_data )
+		  , m_size( other.m_size )
+		  , m_offset( other.m_offset )
+		  , m_fd( other.m_fd )
 		  , m_is_copy( true ) {}
 
 		shared_memory &operator=( shared_memory const &rhs ) noexcept {
 			if( this != &rhs ) {
 				cleanup( );
 				m_data = rhs.m_data;
+				m_size = rhs.m_size;
+				m_offset = rhs.m_offset;
+				m_fd = rhs.m_fd;
 			}
 			return *this;
 		}
 
 		shared_memory( shared_memory &&other ) noexcept
 		  : m_data( std::exchange( other.m_data, nullptr ) )
+		  , m_size( std::exchange( other.m_size, 0 ) )
+		  , m_offset( std::exchange( other.m_offset, 0 ) )
+		  , m_fd( std::exchange( other.m_fd, -1 ) )
 		  , m_is_copy( std::exchange( other.m_is_copy, true ) ) {}
 
 		shared_memory &operator=( shared_memory &&rhs ) noexcept {
 			if( this != &rhs ) {
 				cleanup( );
 				m_data = std::exchange( rhs.m_data, nullptr );
+				m_size = std::exchange( rhs.m_size, 0 );
+				m_offset = std::exchange( rhs.m_offset, 0 );
+				m_fd = std::exchange( rhs.m_fd, -1 );
 				m_is_copy = std::exchange( rhs.m_is_copy, true );
 			}
 			return *this;
 		}
 
 		T read( ) const noexcept {
+			static_assert( std::is_trivially_copyable_v<T> );
 			T result;
 			auto ptr =
 			  const_cast<void *>( reinterpret_cast<volatile void *>( m_data ) );
@@ -99,9 +681,197 @@ namespace daw::process {
 		}
 
 		void write( T const &value ) noexcept {
+			static_assert( std::is_trivially_copyable_v<T> );
 			auto ptr =
 			  const_cast<void *>( reinterpret_cast<volatile void *>( m_data ) );
 			memcpy( ptr, &value, sizeof( T ) );
 		}
 	};
+
+	// A runtime sized array of T in shared memory, backed by an anonymous file
+	// so that it can be grown.  The size is that of the file, after another
+	// process resizes it call refresh( ) to see the new size.  It never shrinks,
+	// as other processes touching the end of their mapping would get SIGBUS.
+	// Copies refer to the same file but have their own mapping
+	template<typename T>
+	class shared_memory<T[]> {
+		static_assert( std::is_trivially_copyable_v<T> );
+		static_assert( std::is_default_constructible_v<T> );
+
+		int m_fd = -1;
+		bool m_is_copy = false;
+		T *m_data = nullptr;
+		size_t m_size = 0;
+		size_t m_map_size = 0;
+		shared_memory_options m_opts{};
+
+		void unmap( ) noexcept {
+			if( auto tmp = std::exchange( m_data, nullptr ); tmp ) {
+				munmap( tmp, m_map_size );
+			}
+			m_size = 0;
+			m_map_size = 0;
+		}
+
+		void cleanup( ) noexcept {
+			unmap( );
+			if( !std::exchange( m_is_copy, true ) ) {
+				if( auto tmp = std::exchange( m_fd, -1 ); tmp >= 0 ) {
+					close( tmp );
+				}
+			}
+		}
+
+		void map( size_t bytes ) {
+			if( bytes == 0 ) {
+				unmap( );
+				return;
+			}
+			auto const old_size = m_map_size;
+			void *result = MAP_FAILED;
+#if defined( __linux__ )
+			if( m_data ) {
+				result = mremap( m_data, m_map_size, bytes, MREMAP_MAYMOVE );
+			} else
+#endif
+			{
+				unmap( );
+				result = mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+				               m_fd, 0 );
+			}
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  result == MAP_FAILED, "Error mapping shared array" );
+			m_data = static_cast<T *>( result );
+			m_map_size = bytes;
+			m_size = bytes / sizeof( T );
+			if( bytes > old_size ) {
+				// Only the pages added to the mapping need to be set up
+				auto const page_size = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+				auto const first = ( old_size / page_size ) * page_size;
+				impl::apply_options(
+				  impl::mapping_t{static_cast<char *>( result ) + first, bytes - first},
+				  m_opts, false );
+			}
+		}
+
+	public:
+		using value_type = T;
+		using pointer = T *;
+		using iterator = T *;
+
+		shared_memory( ) noexcept = default;
+
+		explicit shared_memory( size_t count,
+		                        shared_memory_options const &opts = {} )
+		  : m_fd( impl::create_memfd( "daw_shared_array" ) )
+		  , m_opts( opts ) {
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  m_fd < 0, "Error creating shared array" );
+#if defined( __linux__ )
+			// Keeps a process with a stale size( ) from shrinking it in resize( )
+			(void)fcntl( m_fd, F_ADD_SEALS, F_SEAL_SHRINK );
+#endif
+			resize( count );
+		}
+
+		~shared_memory( ) noexcept {
+			cleanup( );
+		}
+
+		shared_memory( shared_memory const &other )
+		  : m_fd( other.m_fd )
+		  , m_is_copy( true )
+		  , m_opts( other.m_opts ) {
+			if( m_fd >= 0 ) {
+				map( other.m_map_size );
+			}
+		}
+
+		shared_memory &operator=( shared_memory const &rhs ) {
+			if( this != &rhs ) {
+				cleanup( );
+				m_fd = rhs.m_fd;
+				m_opts = rhs.m_opts;
+				if( m_fd >= 0 ) {
+					map( rhs.m_map_size );
+				}
+			}
+			return *this;
+		}
+
+		shared_memory( shared_memory &&other ) noexcept
+		  : m_fd( std::exchange( other.m_fd, -1 ) )
+		  , m_is_copy( std::exchange( other.m_is_copy, true ) )
+		  , m_data( std::exchange( other.m_data, nullptr ) )
+		  , m_size( std::exchange( other.m_size, 0 ) )
+		  , m_map_size( std::exchange( other.m_map_size, 0 ) )
+		  , m_opts( other.m_opts ) {}
+
+		shared_memory &operator=( shared_memory &&rhs ) noexcept {
+			if( this != &rhs ) {
+				cleanup( );
+				m_fd = std::exchange( rhs.m_fd, -1 );
+				m_is_copy = std::exchange( rhs.m_is_copy, true );
+				m_data = std::exchange( rhs.m_data, nullptr );
+				m_size = std::exchange( rhs.m_size, 0 );
+				m_map_size = std::exchange( rhs.m_map_size, 0 );
+				m_opts = rhs.m_opts;
+			}
+			return *this;
+		}
+
+		// Grow the array, new elements are zero.  Throws when count is smaller
+		// than size( ).  Other processes keep their current view until they call
+		// refresh( )
+		void resize( size_t count ) {
+			daw::exception::daw_throw_on_true<std::invalid_argument>(
+			  count < m_size, "A shared array can only grow" );
+			auto const bytes = count * sizeof( T );
+			daw::exception::daw_throw_on_true<std::runtime_error>(
+			  !impl::grow_file( m_fd, bytes ), "Error resizing shared array" );
+			map( bytes );
+		}
+
+		// Remap to the size most recently set by any process
+		void refresh( ) {
+			map( ( impl::file_size( m_fd ) / sizeof( T ) ) * sizeof( T ) );
+		}
+
+		int native_handle( ) const noexcept {
+			return m_fd;
+		}
+
+		pointer data( ) const noexcept {
+			return m_data;
+		}
+
+		size_t size( ) const noexcept {
+			return m_size;
+		}
+
+		bool empty( ) const noexcept {
+			return m_size == 0;
+		}
+
+		iterator begin( ) const noexcept {
+			return m_data;
+		}
+
+		iterator end( ) const noexcept {
+			return m_data + m_size;
+		}
+
+		T &operator[]( size_t idx ) const noexcept {
+			return m_data[idx];
+		}
+
+		buffer_span<T> span( ) const noexcept {
+			return {m_data, m_size};
+		}
+
+		// The elements [first, first + count) for a worker to use in place
+		buffer_span<T> subspan( size_t first, size_t count ) const noexcept {
+			return {m_data + first, count};
+		}
+	};
 } // namespace daw::process
@@ -22,10 +22,14 @@
 
 #pragma once
 
+#include <cerrno>
 #include <pthread.h>
+#include <string>
 
 #include <daw/daw_exception.h>
 
+#include "daw_futex.h"
+#include "daw_metrics.h"
 #include "daw_shared_memory.h"
 
 namespace daw::process {
@@ -45,6 +49,16 @@ namespace daw::process {
 				}
 			}
 
+			// A robust mutex is handed to the next locker with EOWNERDEAD when its
+			// owner exits without unlocking it
+			void set_robust( ) {
+#if defined( __linux__ )
+				if( !err ) {
+					err = pthread_mutexattr_setrobust( &value, PTHREAD_MUTEX_ROBUST );
+				}
+#endif
+			}
+
 			~pthread_mutex_attribute( ) noexcept {
 				if( !err ) {
 					pthread_mutexattr_destroy( &value );
@@ -59,46 +73,106 @@ namespace daw::process {
 				return &value;
 			}
 		};
+
+		inline void init_shared_mutex( pthread_mutex_t &mtx ) {
+			auto attr = impl::pthread_mutex_attribute( );
+			attr.set_shared( );
+			attr.set_robust( );
+			daw::exception::daw_throw_on_false( attr );
+
+			auto err = pthread_mutex_init( &mtx, attr );
+			daw::exception::daw_throw_on_true( err );
+		}
 	} // namespace impl
 
-	class shared_mutex {
+	// An interprocess mutex.  Locking spins for a short time before parking in
+	// the kernel.  If a process dies while holding it, the next lock succeeds
+	// and owner_died( ) is true until unlock so that the protected state can be
+	// checked and repaired
+	template<typename Metrics = no_metrics>
+	class basic_shared_mutex : private Metrics {
 		daw::process::shared_memory<pthread_mutex_t> m_mutex{};
 		bool m_is_copy = false;
+		bool m_owner_died = false;
+
+		// Returns true if the lock was acquired
+		bool handle_lock_result( int err ) {
+			if( err == 0 ) {
+				return true;
+			}
+#if defined( __linux__ )
+			if( err == EOWNERDEAD ) {
+				m_owner_died = true;
+				return true;
+			}
+#endif
+			if( err == EBUSY ) {
+				return false;
+			}
+			daw::exception::daw_throw_on_true( err );
+			return false;
+		}
+
+		bool try_lock_mutex( ) {
+			return handle_lock_result( pthread_mutex_trylock( m_mutex.data( ) ) );
+		}
+
+		void lock_mutex( ) {
+			for( size_t n = 0; n < impl::spin_count; ++n ) {
+				if( try_lock_mutex( ) ) {
+					return;
+				}
+				impl::cpu_relax( );
+			}
+			handle_lock_result( pthread_mutex_lock( m_mutex.data( ) ) );
+		}
 
 	public:
-		shared_mutex( ) {
-			auto attr = impl::pthread_mutex_attribute( );
-			attr.set_shared();
-			daw::exception::daw_throw_on_false( attr );
+		basic_shared_mutex( ) {
+			impl::init_shared_mutex( *m_mutex.data( ) );
+		}
 
-			auto err = pthread_mutex_init( m_mutex.data( ), attr );
-			daw::exception::daw_throw_on_true( err );
+		// Attach to the mutex called name.  A named mutex outlives this object
+		// and is never destroyed, only removed
+		basic_shared_mutex( open_or_create_t, std::string const &name )
+		  : Metrics( open_or_create, name + ".metrics" )
+		  , m_mutex( open_or_create, name, impl::init_shared_mutex )
+		  , m_is_copy( true ) {}
+
+		static bool remove( std::string const &name ) noexcept {
+			auto result = shared_memory<pthread_mutex_t>::remove( name );
+			result &= Metrics::remove( name + ".metrics" );
+			return result;
 		}
 
-		~shared_mutex( ) noexcept {
+		~basic_shared_mutex( ) noexcept {
 			if( !std::exchange( m_is_copy, true ) ) {
 				pthread_mutex_destroy( m_mutex.data( ) );
 			}
 		}
 
-		shared_mutex( shared_mutex const &other ) noexcept
-		  : m_mutex( other.m_mutex )
+		basic_shared_mutex( basic_shared_mutex const &other ) noexcept
+		  : Metrics( other )
+		  , m_mutex( other.m_mutex )
 		  , m_is_copy( true ) {}
 
-		shared_mutex &operator=( shared_mutex const &rhs ) noexcept {
+		basic_shared_mutex &operator=( basic_shared_mutex const &rhs ) noexcept {
 			if( this != &rhs ) {
+				Metrics::operator=( rhs );
 				m_mutex = rhs.m_mutex;
 				m_is_copy = true;
 			}
 			return *this;
 		}
 
-		shared_mutex( shared_mutex &&other ) noexcept
-		  : m_mutex( other.m_mutex )
+		basic_shared_mutex( basic_shared_mutex &&other ) noexcept
+		  : Metrics( std::move( other ) )
+		  , m_mutex( other.m_mutex )
 		  , m_is_copy( std::exchange( other.m_is_copy, true ) ) {}
 
-		shared_mutex &operator=( shared_mutex &&rhs ) noexcept {
+		basic_shared_mutex &operator=( basic_shared_mutex &&rhs ) noexcept {
 			if( this != &rhs ) {
+				Metrics::operator=( std::move( rhs ) );
 				m_mutex = rhs.m_mutex;
 				m_is_copy = std::exchange( rhs.m_is_copy, true );
 			}
@@ -106,18 +180,51 @@ namespace daw::process {
 		}
 
 		void lock( ) {
-			auto const err = pthread_mutex_lock( m_mutex.data( ) );
-			daw::exception::daw_throw_on_true( err );
+			this->acquire(
+			  metrics_side::write, [&] { return try_lock_mutex( ); },
+			  [&] { lock_mutex( ); } );
+			this->record_locked( );
 		}
 
-		void try_lock( ) {
-			auto const err = pthread_mutex_trylock( m_mutex.data( ) );
-			daw::exception::daw_throw_on_true( err );
+		bool try_lock( ) {
+			if( try_lock_mutex( ) ) {
+				this->record_acquired( metrics_side::write );
+				this->record_locked( );
+				return true;
+			}
+			return false;
 		}
 
 		void unlock( ) {
+			this->record_released( );
+			if( m_owner_died ) {
+				// Not repaired explicitly, keep the mutex usable for others
+				consistent( );
+			}
 			auto const err = pthread_mutex_unlock( m_mutex.data( ) );
 			daw::exception::daw_throw_on_true( err );
 		}
+
+		// True while holding a lock whose previous owner died holding it
+		bool owner_died( ) const noexcept {
+			return m_owner_died;
+		}
+
+		// Mark the state protected by the lock as repaired after owner_died( )
+		void consistent( ) {
+			if( std::exchange( m_owner_died, false ) ) {
+#if defined( __linux__ )
+				auto const err = pthread_mutex_consistent( m_mutex.data( ) );
+				daw::exception::daw_throw_on_true( err );
+#endif
+			}
+		}
+
+		// Counters of this mutex, all zero unless Metrics is shared_metrics
+		metrics_snapshot metrics( ) const noexcept {
+			return Metrics::snapshot( );
+		}
 	};
+
+	using shared_mutex = basic_shared_mutex<>;
 } // namespace daw::process
@@ -0,0 +1,213 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "daw_futex.h"
+#include "daw_metrics.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		struct rw_mutex_state_t {
+			std::atomic<uint32_t> m_state;
+			std::atomic<uint32_t> m_waiters;
+		};
+
+		inline constexpr uint32_t rw_writer = 1U << 31U;
+		inline constexpr uint32_t rw_writer_waiting = 1U << 30U;
+		inline constexpr uint32_t rw_reader_mask = rw_writer_waiting - 1U;
+	} // namespace impl
+
+	// A reader/writer lock in shared memory that can be used with
+	// std::shared_lock and std::unique_lock.  Readers only share the lock word,
+	// a waiting writer stops new readers from entering so that it is not
+	// starved
+	template<typename Metrics = no_metrics>
+	class basic_shared_rw_mutex : private Metrics {
+		daw::process::shared_memory<impl::rw_mutex_state_t> m_state{};
+
+		impl::rw_mutex_state_t &state( ) noexcept {
+			return *m_state.data( );
+		}
+
+		// Wait for the lock word to change from current
+		void wait( uint32_t current ) noexcept {
+			auto &st = state( );
+			for( size_t n = 0; n < impl::spin_count; ++n ) {
+				if( st.m_state.load( std::memory_order_relaxed ) != current ) {
+					return;
+				}
+				impl::cpu_relax( );
+			}
+			st.m_waiters.fetch_add( 1, std::memory_order_seq_cst );
+			impl::futex_wait( &st.m_state, current );
+			st.m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+		}
+
+		void wake( ) noexcept {
+			auto &st = state( );
+			if( st.m_waiters.load( std::memory_order_seq_cst ) > 0 ) {
+				impl::futex_wake_all( &st.m_state );
+			}
+		}
+
+		void lock_writer( ) noexcept {
+			auto &lck = state( ).m_state;
+			auto current = lck.load( std::memory_order_relaxed );
+			while( true ) {
+				if( ( current & ( impl::rw_writer | impl::rw_reader_mask ) ) == 0 ) {
+					if( lck.compare_exchange_weak( current, impl::rw_writer,
+					                               std::memory_order_seq_cst,
+					                               std::memory_order_relaxed ) ) {
+						return;
+					}
+				} else if( ( current & impl::rw_writer_waiting ) == 0 ) {
+					lck.compare_exchange_weak( current,
+					                           current | impl::rw_writer_waiting,
+					                           std::memory_order_seq_cst,
+					                           std::memory_order_relaxed );
+				} else {
+					wait( current );
+					current = lck.load( std::memory_order_relaxed );
+				}
+			}
+		}
+
+		bool try_lock_writer( ) noexcept {
+			auto &lck = state( ).m_state;
+			auto current = lck.load( std::memory_order_relaxed );
+			while( ( current & ( impl::rw_writer | impl::rw_reader_mask ) ) == 0 ) {
+				if( lck.compare_exchange_weak( current, impl::rw_writer,
+				                               std::memory_order_seq_cst,
+				                               std::memory_order_relaxed ) ) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void lock_reader( ) noexcept {
+			auto &lck = state( ).m_state;
+			auto current = lck.load( std::memory_order_relaxed );
+			while( true ) {
+				if( ( current & ( impl::rw_writer | impl::rw_writer_waiting ) ) == 0 ) {
+					if( lck.compare_exchange_weak( current, current + 1,
+					                               std::memory_order_seq_cst,
+					                               std::memory_order_relaxed ) ) {
+						return;
+					}
+				} else {
+					wait( current );
+					current = lck.load( std::memory_order_relaxed );
+				}
+			}
+		}
+
+		bool try_lock_reader( ) noexcept {
+			auto &lck = state( ).m_state;
+			auto current = lck.load( std::memory_order_relaxed );
+			while( ( current & ( impl::rw_writer | impl::rw_writer_waiting ) ) ==
+			       0 ) {
+				if( lck.compare_exchange_weak( current, current + 1,
+				                               std::memory_order_seq_cst,
+				                               std::memory_order_relaxed ) ) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+	public:
+		basic_shared_rw_mutex( ) noexcept = default;
+
+		basic_shared_rw_mutex( open_or_create_t, std::string const &name )
+		  : Metrics( open_or_create, name + ".metrics" )
+		  , m_state( open_or_create, name ) {}
+
+		static bool remove( std::string const &name ) noexcept {
+			auto result = shared_memory<impl::rw_mutex_state_t>::remove( name );
+			result &= Metrics::remove( name + ".metrics" );
+			return result;
+		}
+
+		void lock( ) noexcept {
+			this->acquire(
+			  metrics_side::write, [&] { return try_lock_writer( ); },
+			  [&] { lock_writer( ); } );
+			this->record_locked( );
+		}
+
+		bool try_lock( ) noexcept {
+			if( try_lock_writer( ) ) {
+				this->record_acquired( metrics_side::write );
+				this->record_locked( );
+				return true;
+			}
+			return false;
+		}
+
+		void unlock( ) noexcept {
+			this->record_released( );
+			// Waiting writers set their flag again when they wake
+			state( ).m_state.store( 0, std::memory_order_seq_cst );
+			wake( );
+		}
+
+		// Shared holds are counted on the read side, their hold time is not
+		// recorded
+		void lock_shared( ) noexcept {
+			this->acquire(
+			  metrics_side::read, [&] { return try_lock_reader( ); },
+			  [&] { lock_reader( ); } );
+		}
+
+		bool try_lock_shared( ) noexcept {
+			if( try_lock_reader( ) ) {
+				this->record_acquired( metrics_side::read );
+				return true;
+			}
+			return false;
+		}
+
+		void unlock_shared( ) noexcept {
+			auto const prev =
+			  state( ).m_state.fetch_sub( 1, std::memory_order_seq_cst );
+			// Only a writer waits on readers leaving
+			if( ( prev & impl::rw_reader_mask ) == 1 and
+			    ( prev & impl::rw_writer_waiting ) != 0 ) {
+				wake( );
+			}
+		}
+
+		// Counters of this mutex, all zero unless Metrics is shared_metrics
+		metrics_snapshot metrics( ) const noexcept {
+			return Metrics::snapshot( );
+		}
+	};
+
+	using shared_rw_mutex = basic_shared_rw_mutex<>;
+} // namespace daw::process
@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <sched.h>
+#include <string>
+#include <type_traits>
+
+#include "daw_futex.h"
+#include "daw_shared_memory.h"
+
+namespace daw::process {
+	namespace impl {
+		template<typename T>
+		struct seqlock_t {
+			// Odd while a writer is updating m_value
+			std::atomic<uint32_t> m_sequence;
+			T m_value;
+		};
+	} // namespace impl
+
+	// A value in shared memory for read mostly state.  Readers copy it out and
+	// retry if a writer changed it meanwhile, so they never write to the shared
+	// cache line and never block a writer.  Writers are serialized
+	template<typename T>
+	class shared_seqlock {
+		static_assert( std::is_trivially_copyable_v<T> );
+		static_assert( std::is_default_constructible_v<T> );
+
+		daw::process::shared_memory<impl::seqlock_t<T>> m_state{};
+
+		impl::seqlock_t<T> &state( ) noexcept {
+			return *m_state.data( );
+		}
+
+		uint32_t write_lock( ) noexcept {
+			auto &seq = state( ).m_sequence;
+			auto current = seq.load( std::memory_order_relaxed );
+			size_t spins = 0;
+			while( true ) {
+				if( ( current & 1U ) == 0 and
+				    seq.compare_exchange_weak( current, current + 1,
+				                               std::memory_order_acquire,
+				                               std::memory_order_relaxed ) ) {
+					// Keep the writes to m_value after the sequence is odd
+					std::atomic_thread_fence( std::memory_order_release );
+					return current + 1;
+				}
+				if( ++spins < impl::spin_count ) {
+					impl::cpu_relax( );
+				} else {
+					sched_yield( );
+				}
+				current = seq.load( std::memory_order_relaxed );
+			}
+		}
+
+		void write_unlock( uint32_t sequence ) noexcept {
+			state( ).m_sequence.store( sequence + 1, std::memory_order_release );
+		}
+
+	public:
+		shared_seqlock( ) noexcept = default;
+
+		explicit shared_seqlock( T const &value ) noexcept {
+			store( value );
+		}
+
+		// value is only used by the process that creates the seqlock
+		shared_seqlock( open_or_create_t, std::string const &name,
+		                T const &value = T{} )
+		  : m_state( open_or_create, name,
+		             [&value]( impl::seqlock_t<T> &st ) {
+			             memcpy( &st.m_value, &value, sizeof( T ) );
+		             } ) {}
+
+		static bool remove( std::string const &name ) noexcept {
+			return shared_memory<impl::seqlock_t<T>>::remove( name );
+		}
+
+		// A consistent copy of the value
+		T load( ) noexcept {
+			auto &st = state( );
+			T result;
+			while( true ) {
+				auto const before = st.m_sequence.load( std::memory_order_acquire );
+				if( ( before & 1U ) == 0 ) {
+					memcpy( &result, &st.m_value, sizeof( T ) );
+					std::atomic_thread_fence( std::memory_order_acquire );
+					if( st.m_sequence.load( std::memory_order_relaxed ) == before ) {
+						return result;
+					}
+				}
+				impl::cpu_relax( );
+			}
+		}
+
+		void store( T const &value ) noexcept {
+			auto const sequence = write_lock( );
+			memcpy( &state( ).m_value, &value, sizeof( T ) );
+			write_unlock( sequence );
+		}
+
+		// Call func( T & ) on the value while holding out other writers
+		template<typename Function>
+		void update( Function &&func ) {
+			auto const sequence = write_lock( );
+			try {
+				func( state( ).m_value );
+			} catch( ... ) {
+				write_unlock( sequence );
+				throw;
+			}
+			write_unlock( sequence );
+		}
+	};
+} // namespace daw::process
@@ -31,12 +31,40 @@
 #include "daw_collection_channel.h"
 
 namespace daw::process {
-	template<typename CharT = char, size_t buff_size = 20>
+	template<typename CharT = char, size_t buff_size = 20,
+	         typename Metrics = no_metrics>
 	class string_channel {
-		daw::process::collection_channel<CharT, buff_size> m_channel{};
+		daw::process::collection_channel<CharT, buff_size, Metrics> m_channel{};
 
 	public:
-		string_channel( ) noexcept = default;
+		string_channel( ) = default;
+
+		explicit string_channel( size_t chars_per_message,
+		                         shared_memory_options const &opts = {} )
+		  : m_channel( chars_per_message, opts ) {}
+
+		// Lease room for count characters directly in the shared buffer
+		buffer_span<CharT> acquire_write( size_t count ) {
+			return m_channel.acquire_write( count );
+		}
+
+		void commit( ) noexcept {
+			m_channel.commit( );
+		}
+
+		void commit( size_t count ) {
+			m_channel.commit( count );
+		}
+
+		// View the next message in place, it is valid until release is called
+		std::basic_string_view<CharT> acquire_read( ) {
+			auto const msg = m_channel.acquire_read( );
+			return {msg.data( ), msg.size( )};
+		}
+
+		void release( ) noexcept {
+			m_channel.release( );
+		}
 
 		inline void write( std::basic_string_view<CharT> sv ) {
 			m_channel.write( sv );
@@ -45,5 +73,9 @@ namespace daw::process {
 		inline std::basic_string<CharT> read( ) {
 			return m_channel.template read<std::basic_string<CharT>>( );
 		}
+
+		metrics_snapshot metrics( ) const noexcept {
+			return m_channel.metrics( );
+		}
 	};
 } // namespace daw::process
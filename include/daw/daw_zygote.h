@@ -0,0 +1,348 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <tuple>
+#include <type_traits>
+#include <unistd.h>
+
+#include <daw/daw_exception.h>
+
+#include "daw_channel.h"
+#include "daw_process.h"
+#include "daw_process_reaper.h"
+#include "daw_semaphore.h"
+#include "daw_shared_memory.h"
+#include "daw_shared_mutex.h"
+
+namespace daw::process {
+	namespace impl {
+		inline constexpr size_t zygote_args_size = 256;
+		inline constexpr size_t zygote_result_size = 256;
+		inline constexpr size_t zygote_slot_count = 64;
+
+		struct zygote_result_t {
+			std::atomic<uint32_t> m_is_set;
+			alignas( std::max_align_t )
+			  std::array<std::byte, zygote_result_size> m_value;
+		};
+
+		struct zygote_results_t {
+			// A set bit is a free slot
+			std::atomic<uint64_t> m_free;
+			std::array<zygote_result_t, zygote_slot_count> m_slots;
+		};
+		static_assert( zygote_slot_count <= 64 );
+
+		// The result slots.  The reaper's callbacks share ownership of them, so
+		// they stay mapped until the last callback is done even if the zygote
+		// is destroyed first
+		class zygote_slots_t {
+			daw::process::semaphore m_free_slots{
+			  static_cast<int>( zygote_slot_count )};
+			daw::process::shared_memory<zygote_results_t> m_results{};
+
+		public:
+			zygote_slots_t( ) {
+				m_results.data( )->m_free.store(
+				  ~uint64_t{0} >> ( 64U - zygote_slot_count ),
+				  std::memory_order_relaxed );
+			}
+
+			zygote_result_t *acquire( ) noexcept {
+				m_free_slots.wait( );
+				auto &free = m_results.data( )->m_free;
+				auto mask = free.load( std::memory_order_relaxed );
+				while( true ) {
+					auto const bit = mask & ( ~mask + 1 );
+					if( free.compare_exchange_weak( mask, mask & ~bit,
+					                                std::memory_order_acquire ) ) {
+						auto index = size_t{0};
+						while( ( bit >> index ) != 1 ) {
+							++index;
+						}
+						return &m_results.data( )->m_slots[index];
+					}
+				}
+			}
+
+			void release( zygote_result_t *slot ) noexcept {
+				auto const index =
+				  static_cast<size_t>( slot - m_results.data( )->m_slots.data( ) );
+				slot->m_is_set.store( 0, std::memory_order_relaxed );
+				m_results.data( )->m_free.fetch_or( uint64_t{1} << index,
+				                                    std::memory_order_release );
+				m_free_slots.post( );
+			}
+
+			// Blocks until every slot has been released
+			void wait_all( ) noexcept {
+				for( size_t n = 0; n < zygote_slot_count; ++n ) {
+					m_free_slots.wait( );
+				}
+			}
+		};
+
+		// The caller stays a child subreaper while any zygote it created is
+		// alive and goes back to its previous setting after the last one
+		struct subreaper_state_t {
+			std::mutex m_mutex{};
+			::pid_t m_owner = -1;
+			size_t m_users = 0;
+			int m_previous = 0;
+		};
+
+		inline subreaper_state_t &subreaper_state( ) {
+			static auto result = subreaper_state_t{};
+			return result;
+		}
+
+		inline void acquire_subreaper( ) {
+			auto &st = subreaper_state( );
+			auto const lck = std::lock_guard( st.m_mutex );
+			if( st.m_owner != getpid( ) ) {
+				// Copied by fork, the setting itself is not inherited
+				st.m_owner = getpid( );
+				st.m_users = 0;
+			}
+			if( st.m_users == 0 ) {
+				daw::exception::daw_throw_on_true<std::runtime_error>(
+				  prctl( PR_GET_CHILD_SUBREAPER, &st.m_previous ) != 0 or
+				    prctl( PR_SET_CHILD_SUBREAPER, 1 ) != 0,
+				  "Error becoming a child subreaper" );
+			}
+			++st.m_users;
+		}
+
+		inline void release_subreaper( ) noexcept {
+			auto &st = subreaper_state( );
+			auto const lck = std::lock_guard( st.m_mutex );
+			if( st.m_owner == getpid( ) and --st.m_users == 0 and
+			    st.m_previous == 0 ) {
+				(void)prctl( PR_SET_CHILD_SUBREAPER, 0 );
+			}
+		}
+
+		struct zygote_request_t;
+		using zygote_entry_t = void ( * )( zygote_request_t const & );
+
+		struct zygote_request_t {
+			// nullptr asks the zygote to exit
+			zygote_entry_t m_entry;
+			zygote_result_t *m_result;
+			alignas( std::max_align_t )
+			  std::array<std::byte, zygote_args_size> m_args;
+		};
+
+		template<typename Function, typename... Args>
+		struct zygote_payload_t {
+			Function m_func;
+			std::tuple<Args...> m_args;
+		};
+
+		// Runs in the worker, the payload was placed in m_args by the caller
+		template<typename Payload>
+		void zygote_entry( zygote_request_t const &req ) {
+			auto &payload = *std::launder( reinterpret_cast<Payload *>(
+			  const_cast<std::byte *>( req.m_args.data( ) ) ) );
+			using result_t =
+			  decltype( std::apply( payload.m_func, payload.m_args ) );
+			if constexpr( std::is_void_v<result_t> ) {
+				std::apply( payload.m_func, payload.m_args );
+			} else {
+				auto const result = std::apply( payload.m_func, payload.m_args );
+				if( req.m_result != nullptr ) {
+					memcpy( req.m_result->m_value.data( ), &result, sizeof( result ) );
+					req.m_result->m_is_set.store( 1, std::memory_order_release );
+				}
+			}
+		}
+	} // namespace impl
+
+	// A small process forked before the caller's heap grows that forks workers
+	// on its behalf, so that spawning does not copy the caller's page tables
+	// and the workers take no copy on write faults from it.  The caller becomes
+	// a child subreaper and the workers are reparented to it, so they are
+	// waited on like any other child.  That setting is process wide, so
+	// orphaned grandchildren from elsewhere are reparented to the caller too
+	// until the last zygote is destroyed and the previous setting restored.
+	// As the zygote does not see memory the caller maps later, it runs plain
+	// function pointers with trivially copyable arguments and results, a
+	// captureless lambda can be passed with unary +.  The zygote is killed
+	// when the thread that created it exits.  Workers should be spawned from
+	// the process that created the zygote
+	class zygote {
+		daw::process::channel<impl::zygote_request_t> m_requests{};
+		daw::process::channel<::pid_t> m_replies{};
+		daw::process::shared_mutex m_lock{};
+		std::shared_ptr<impl::zygote_slots_t> m_slots =
+		  std::make_shared<impl::zygote_slots_t>( );
+		daw::process::fork_process<> m_process{};
+
+		// The zygote's loop.  Each worker is forked from a short lived middle
+		// process so that it is orphaned and reparented to the caller
+		void serve( ::pid_t caller ) {
+			prctl( PR_SET_PDEATHSIG, SIGKILL );
+			if( getppid( ) != caller ) {
+				return;
+			}
+			auto spawned = daw::process::shared_memory<::pid_t>( );
+			while( true ) {
+				auto const req = m_requests.read( );
+				if( req.m_entry == nullptr ) {
+					return;
+				}
+				::pid_t pid = -1;
+				auto const middle = fork( );
+				if( middle == 0 ) {
+					auto const worker = fork( );
+					if( worker == 0 ) {
+						req.m_entry( req );
+						exit( 0 );
+					}
+					spawned.write( worker );
+					_exit( 0 );
+				} else if( middle > 0 ) {
+					int status = 0;
+					while( waitpid( middle, &status, 0 ) < 0 and errno == EINTR ) {}
+					// The worker has been reparented once the middle process is gone
+					pid = spawned.read( );
+				}
+				m_replies.write( pid );
+			}
+		}
+
+		template<typename Function, typename... Args>
+		::pid_t launch( impl::zygote_result_t *result, Function func,
+		                Args &&... args ) {
+			static_assert( std::is_pointer_v<Function> and
+			                 std::is_function_v<std::remove_pointer_t<Function>>,
+			               "The zygote can only run function pointers" );
+			static_assert(
+			  ( std::is_trivially_copyable_v<std::decay_t<Args>> and ... ),
+			  "Arguments must be trivially copyable" );
+			using payload_t = impl::zygote_payload_t<Function, std::decay_t<Args>...>;
+			static_assert( sizeof( payload_t ) <= impl::zygote_args_size );
+			static_assert( alignof( payload_t ) <= alignof( std::max_align_t ) );
+
+			auto req = impl::zygote_request_t{};
+			req.m_entry = &impl::zygote_entry<payload_t>;
+			req.m_result = result;
+			new( req.m_args.data( ) )
+			  payload_t{func, std::tuple<std::decay_t<Args>...>(
+			                    std::forward<Args>( args )... )};
+
+			auto const lck = std::lock_guard( m_lock );
+			m_requests.write( req );
+			return m_replies.read( );
+		}
+
+	public:
+		zygote( ) {
+			impl::acquire_subreaper( );
+			try {
+				m_process =
+				  daw::process::fork_process<>( [this, caller = getpid( )] {
+					  serve( caller );
+				  } );
+			} catch( ... ) {
+				impl::release_subreaper( );
+				throw;
+			}
+		}
+
+		zygote( zygote const & ) = delete;
+		zygote &operator=( zygote const & ) = delete;
+		zygote( zygote && ) = delete;
+		zygote &operator=( zygote && ) = delete;
+
+		// Waits for the results of outstanding async calls and stops the zygote.
+		// Workers already running stay children of the caller
+		~zygote( ) noexcept {
+			m_slots->wait_all( );
+			{
+				auto const lck = std::lock_guard( m_lock );
+				m_requests.write( impl::zygote_request_t{} );
+				m_process.join( );
+			}
+			impl::release_subreaper( );
+		}
+
+		// Start func( args... ) in a worker
+		template<typename Function, typename... Args>
+		daw::process::fork_process<> spawn( Function func, Args &&... args ) {
+			auto const pid = launch( nullptr, func, std::forward<Args>( args )... );
+			daw::exception::daw_throw_on_true<std::runtime_error>( pid < 0,
+			                                                       "Error forking" );
+			return daw::process::fork_process<>( adopt_process, pid );
+		}
+
+		// Run func( args... ) in a worker, the result must be trivially copyable
+		template<typename Function, typename... Args,
+		         typename Ret =
+		           std::decay_t<std::invoke_result_t<Function, Args...>>>
+		std::future<Ret> async( Function func, Args &&... args ) {
+			static_assert( std::is_trivially_copyable_v<Ret> );
+			static_assert( sizeof( Ret ) <= impl::zygote_result_size );
+			auto *slot = m_slots->acquire( );
+			auto const pid = launch( slot, func, std::forward<Args>( args )... );
+			if( pid < 0 ) {
+				m_slots->release( slot );
+			}
+			daw::exception::daw_throw_on_true<std::runtime_error>( pid < 0,
+			                                                       "Error forking" );
+			auto result = std::promise<Ret>( );
+			auto fut = result.get_future( );
+			daw::process::process_reaper::get( ).watch(
+			  pid, [slots = m_slots, slot,
+			        result = std::move( result )]( int ) mutable {
+				  if( slot->m_is_set.load( std::memory_order_acquire ) == 0 ) {
+					  slots->release( slot );
+					  result.set_exception( std::make_exception_ptr(
+					    std::runtime_error( "Error running callable" ) ) );
+					  return;
+				  }
+				  auto const value = *std::launder(
+				    reinterpret_cast<Ret const *>( slot->m_value.data( ) ) );
+				  slots->release( slot );
+				  result.set_value( value );
+			  } );
+			return fut;
+		}
+	};
+} // namespace daw::process
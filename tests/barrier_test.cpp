@@ -0,0 +1,70 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_barrier.h"
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+
+int main( ) {
+	static constexpr int64_t worker_count = 8;
+	static constexpr int64_t phase_count = 1'000;
+	auto sync = daw::process::barrier( worker_count );
+	auto counter = daw::process::shared_memory<std::atomic<int64_t>>( );
+	auto errors = daw::process::shared_memory<std::atomic<int64_t>>( );
+
+	auto workers = std::vector<daw::process::fork_process<>>( );
+	for( int64_t n = 0; n < worker_count; ++n ) {
+		workers.emplace_back( [&] {
+			for( int64_t phase = 0; phase < phase_count; ++phase ) {
+				counter.data( )->fetch_add( 1 );
+				sync.arrive_and_wait( );
+				// Every worker has finished this phase and none has started the next
+				if( counter.data( )->load( ) != ( phase + 1 ) * worker_count ) {
+					errors.data( )->fetch_add( 1 );
+				}
+				sync.arrive_and_wait( );
+			}
+		} );
+	}
+	puts( "parent: waiting for workers\n" );
+	workers.clear( );
+	daw::expecting( errors.data( )->load( ), int64_t{0} );
+	daw::expecting( counter.data( )->load( ), phase_count * worker_count );
+	puts( "parent: all phases complete\n" );
+
+	// A dropped process is no longer waited for in the following phases
+	auto pair = daw::process::barrier( 2 );
+	auto proc = daw::process::fork_process( [&] {
+		pair.arrive_and_wait( );
+		pair.arrive_and_drop( );
+	} );
+	pair.arrive_and_wait( );
+	pair.arrive_and_wait( );
+	pair.arrive_and_wait( );
+}
@@ -0,0 +1,111 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_broadcast_channel.h"
+#include "daw/daw_process.h"
+#include "daw/daw_semaphore.h"
+
+int main( ) {
+	static constexpr size_t reader_count = 4;
+	static constexpr size_t count = 100'000;
+	auto chan = daw::process::broadcast_channel<size_t, 16, 8>( );
+	auto subscribed = daw::process::semaphore( );
+	auto correct = daw::process::semaphore( );
+
+	auto readers = std::vector<daw::process::fork_process<>>( );
+	for( size_t n = 0; n < reader_count; ++n ) {
+		readers.emplace_back( [&] {
+			// Subscribing after fork, the writer waits for all of them
+			auto sub = chan.subscribe( );
+			subscribed.post( );
+			bool is_correct = true;
+			for( size_t i = 0; i < count; ++i ) {
+				is_correct &= sub.read( ) == i;
+			}
+			is_correct &= !sub.try_read( );
+			if( is_correct ) {
+				correct.post( );
+			}
+		} );
+	}
+	for( size_t n = 0; n < reader_count; ++n ) {
+		subscribed.wait( );
+	}
+	puts( "parent: broadcasting\n" );
+	for( size_t i = 0; i < count; ++i ) {
+		chan.write( i );
+	}
+	readers.clear( );
+	for( size_t n = 0; n < reader_count; ++n ) {
+		daw::expecting( correct.try_wait( ) );
+	}
+	puts( "parent: all readers got every value\n" );
+
+	// The slowest subscriber holds back the writer until it is released
+	{
+		auto slow = chan.subscribe( );
+		for( size_t i = 0; i < chan.capacity( ); ++i ) {
+			daw::expecting( chan.try_write( i ) );
+		}
+		daw::expecting( !chan.try_write( 0 ) );
+		daw::expecting( slow.read( ), size_t{0} );
+		daw::expecting( chan.try_write( chan.capacity( ) ) );
+	}
+	daw::expecting( chan.try_write( 0 ) );
+
+	// A subscriber whose process died without releasing it is freed by the
+	// writer, even before that process is reaped
+	auto crashed = daw::process::fork_process( [&] {
+		auto sub = chan.subscribe( );
+		subscribed.post( );
+		_exit( EXIT_FAILURE );
+	} );
+	subscribed.wait( );
+	for( size_t i = 0; i < chan.capacity( ) * 2; ++i ) {
+		chan.write( i );
+	}
+	crashed.join( );
+	puts( "parent: a dead subscriber did not stall the writer\n" );
+
+	auto subs = std::vector<decltype( chan )::subscriber>( );
+	for( size_t n = 0; n < chan.max_subscribers( ); ++n ) {
+		subs.push_back( chan.subscribe( ) );
+	}
+	try {
+		(void)chan.subscribe( );
+		daw::expecting( false );
+	} catch( std::runtime_error const & ) {}
+	subs.pop_back( );
+	auto last = chan.subscribe( );
+	chan.write( 42 );
+	daw::expecting( last.read( ), size_t{42} );
+	daw::expecting( subs.front( ).read( ), size_t{42} );
+}
@@ -21,13 +21,61 @@
 // SOFTWARE.
 
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 #include <unistd.h>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
 
 #include "daw/daw_channel.h"
 #include "daw/daw_process.h"
 
+struct tick_t {
+	int64_t time;
+	double price;
+};
+
+void batch_test( ) {
+	static constexpr size_t count = 10'000;
+	auto chan = daw::process::channel<tick_t>( );
+	daw::expecting( chan.batch_capacity( ) > 1 );
+
+	auto proc = daw::process::fork_process( [&] {
+		auto ticks = std::vector<tick_t>( count );
+		for( size_t n = 0; n < count; ++n ) {
+			ticks[n] = {static_cast<int64_t>( n ), static_cast<double>( n ) / 2.0};
+		}
+		chan.write_n( ticks );
+		chan.write( tick_t{-1, 0.0} );
+	} );
+
+	// Single and batched reads can be mixed
+	daw::expecting( chan.read( ).time, int64_t{0} );
+	auto ticks = std::vector<tick_t>( count - 1 );
+	chan.read_n( ticks );
+	for( size_t n = 0; n < ticks.size( ); ++n ) {
+		daw::expecting( ticks[n].time, static_cast<int64_t>( n + 1 ) );
+	}
+	daw::expecting( chan.read( ).time, int64_t{-1} );
+	proc.join( );
+
+	// A full channel takes nothing and an empty one gives nothing
+	auto const values = std::vector<tick_t>( chan.batch_capacity( ) + 1 );
+	daw::expecting( chan.try_write_n( values ), chan.batch_capacity( ) );
+	daw::expecting( chan.try_write_n( values ), size_t{0} );
+	daw::expecting( !chan.try_write( tick_t{} ) );
+	auto out = std::vector<tick_t>( 3 );
+	daw::expecting( chan.try_read_n( out ), size_t{3} );
+	auto rest = std::vector<tick_t>( chan.batch_capacity( ) );
+	daw::expecting( chan.try_read_n( rest ), chan.batch_capacity( ) - 3 );
+	daw::expecting( chan.try_read_n( rest ), size_t{0} );
+	daw::expecting( !chan.try_read( ) );
+}
+
 int main( ) {
+	batch_test( );
+
 	auto chan = daw::process::channel<unsigned int>( );
 	size_t count = 5;
 	auto proc = daw::process::fork_process(
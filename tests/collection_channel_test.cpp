@@ -22,9 +22,14 @@
 
 #include <cassert>
 #include <cstdio>
+#include <forward_list>
+#include <list>
+#include <numeric>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <unistd.h>
+#include <vector>
 
 #include <daw/daw_benchmark.h>
 
@@ -76,4 +81,41 @@ int main( ) {
 		show( val );
 		daw::expecting( val, mul( message, count ) );
 	}
+
+	auto big_chan =
+	  daw::process::collection_channel<int>( 64U * 1024U / sizeof( int ) );
+	auto proc2 = daw::process::fork_process( [&]( ) {
+		auto big = std::vector<int>( 10'000'000 );
+		std::iota( big.begin( ), big.end( ), 0 );
+		big_chan.write( big );
+		big_chan.write( std::vector<int>( ) );
+		big_chan.write( std::list<int>{1, 2, 3} );
+		// No size, so it is counted while it is sent
+		auto unsized = std::forward_list<int>( 40'000 );
+		std::iota( unsized.begin( ), unsized.end( ), 0 );
+		big_chan.write( unsized );
+		big_chan.write( std::forward_list<int>( ) );
+	} );
+	auto const big = big_chan.read( );
+	daw::expecting( big.size( ), 10'000'000U );
+	for( size_t n = 0; n < big.size( ); ++n ) {
+		daw::expecting( big[n], static_cast<int>( n ) );
+	}
+	daw::expecting( big_chan.read( ).empty( ) );
+	daw::expecting( big_chan.read( ), std::vector<int>{1, 2, 3} );
+	auto const unsized = big_chan.read( );
+	daw::expecting( unsized.size( ), 40'000U );
+	daw::expecting( unsized.back( ), 39'999 );
+	daw::expecting( big_chan.read( ).empty( ) );
+
+	// A commit cannot send more than was leased, the lease is kept
+	auto lease = big_chan.acquire_write( 3 );
+	std::iota( lease.begin( ), lease.end( ), 10 );
+	bool has_thrown = false;
+	try {
+		big_chan.commit( 4 );
+	} catch( std::out_of_range const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+	big_chan.commit( 2 );
+	daw::expecting( big_chan.read( ), std::vector<int>{10, 11} );
 }
@@ -0,0 +1,76 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_condition_variable.h"
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+#include "daw/daw_shared_mutex.h"
+
+int main( ) {
+	using namespace std::chrono_literals;
+	static constexpr int waiter_count = 4;
+	auto mtx = daw::process::shared_mutex( );
+	auto cv = daw::process::condition_variable( );
+	auto state = daw::process::shared_memory<int>( );
+	auto woken = daw::process::shared_memory<std::atomic<int64_t>>( );
+
+	auto waiters = std::vector<daw::process::fork_process<>>( );
+	for( int n = 0; n < waiter_count; ++n ) {
+		waiters.emplace_back( [&] {
+			auto lck = std::unique_lock( mtx );
+			cv.wait( lck, [&] { return *state.data( ) == 1; } );
+			woken.data( )->fetch_add( 1 );
+			cv.notify_all( );
+		} );
+	}
+
+	puts( "parent: notifying all\n" );
+	{
+		auto lck = std::unique_lock( mtx );
+		*state.data( ) = 1;
+	}
+	cv.notify_all( );
+	{
+		auto lck = std::unique_lock( mtx );
+		daw::expecting( cv.wait_for( lck, 10s, [&] {
+			return woken.data( )->load( ) == waiter_count;
+		} ) );
+	}
+	waiters.clear( );
+	puts( "parent: all waiters woke\n" );
+
+	auto lck = std::unique_lock( mtx );
+	auto const start = std::chrono::steady_clock::now( );
+	daw::expecting( cv.wait_for( lck, 20ms ) == std::cv_status::timeout );
+	daw::expecting( std::chrono::steady_clock::now( ) - start >= 20ms );
+	daw::expecting( !cv.wait_for( lck, 1ms, [] { return false; } ) );
+}
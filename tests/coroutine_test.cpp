@@ -0,0 +1,200 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_await.h"
+#include "daw/daw_channel.h"
+#include "daw/daw_future_process.h"
+#include "daw/daw_process.h"
+#include "daw/daw_semaphore.h"
+
+#if defined( DAW_PROCESS_HAS_COROUTINES )
+#include <coroutine>
+
+// A coroutine that starts eagerly and is not awaited
+struct detached_task {
+	struct promise_type {
+		detached_task get_return_object( ) noexcept {
+			return {};
+		}
+		std::suspend_never initial_suspend( ) noexcept {
+			return {};
+		}
+		std::suspend_never final_suspend( ) noexcept {
+			return {};
+		}
+		void return_void( ) noexcept {}
+		void unhandled_exception( ) {
+			std::terminate( );
+		}
+	};
+};
+
+// A minimal event loop, the executor queues handles that run( ) resumes
+class event_loop {
+	std::mutex m_mutex{};
+	std::deque<std::coroutine_handle<>> m_ready{};
+
+public:
+	struct executor {
+		event_loop *loop;
+		void operator( )( std::coroutine_handle<> h ) const {
+			auto const lck = std::lock_guard( loop->m_mutex );
+			loop->m_ready.push_back( h );
+		}
+	};
+
+	executor get_executor( ) noexcept {
+		return {this};
+	}
+
+	template<typename Predicate>
+	void run_until( Predicate pred ) {
+		while( !pred( ) ) {
+			auto h = std::coroutine_handle<>( );
+			{
+				auto const lck = std::lock_guard( m_mutex );
+				if( !m_ready.empty( ) ) {
+					h = m_ready.front( );
+					m_ready.pop_front( );
+				}
+			}
+			if( h ) {
+				h.resume( );
+			} else {
+				std::this_thread::yield( );
+			}
+		}
+	}
+};
+
+template<typename Predicate>
+void wait_until( Predicate pred ) {
+	while( !pred( ) ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+}
+
+detached_task wait_on( daw::process::semaphore &sem,
+                       std::atomic<size_t> &done ) {
+	co_await sem.async_wait( );
+	++done;
+}
+
+detached_task record_thread( daw::process::semaphore &sem,
+                             std::atomic<std::thread::id> &id ) {
+	co_await sem.async_wait( );
+	id = std::this_thread::get_id( );
+}
+
+detached_task sum_values( daw::process::channel<int64_t> &chan, int count,
+                          event_loop &loop, int64_t &sum, bool &is_done ) {
+	for( int n = 0; n < count; ++n ) {
+		sum += co_await chan.async_read( loop.get_executor( ) );
+	}
+	is_done = true;
+}
+
+detached_task run_tasks( event_loop &loop, int &value,
+                         std::vector<double> &values, bool &is_done ) {
+	value = co_await daw::process::async_task( []( int v ) { return v * 2; }, 21 )
+	          .resume_on( loop.get_executor( ) );
+	values = co_await daw::process::async_task( [] {
+		         return std::vector<double>( 1000, 1.5 );
+	         } ).resume_on( loop.get_executor( ) );
+	is_done = true;
+}
+
+int main( ) {
+	// More waiting coroutines than fit in one futex_waitv
+	static constexpr size_t sem_count = 200;
+	auto sems = std::vector<daw::process::semaphore>( sem_count );
+	auto waits_done = std::atomic<size_t>( 0 );
+	for( auto &sem : sems ) {
+		wait_on( sem, waits_done );
+	}
+	daw::expecting( waits_done.load( ), size_t{0} );
+	// The last ones are waited on by a second service thread
+	static constexpr size_t late_count = 10;
+	for( size_t n = sem_count - late_count; n < sem_count; ++n ) {
+		sems[n].post( );
+	}
+	wait_until( [&] { return waits_done.load( ) == late_count; } );
+	auto poster = daw::process::fork_process( [&] {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+		for( size_t n = 0; n < sem_count - late_count; ++n ) {
+			sems[n].post( );
+		}
+	} );
+	wait_until( [&] { return waits_done.load( ) == sem_count; } );
+	poster.join( );
+
+	// The default executor resumes on the service thread
+	auto sem = daw::process::semaphore( );
+	auto resumed_on = std::atomic<std::thread::id>( );
+	record_thread( sem, resumed_on );
+	sem.post( );
+	wait_until( [&] { return resumed_on.load( ) != std::thread::id( ); } );
+	daw::expecting( resumed_on.load( ) != std::this_thread::get_id( ) );
+
+	auto loop = event_loop( );
+	static constexpr int value_count = 500;
+	auto chan = daw::process::channel<int64_t>( );
+	int64_t sum = 0;
+	bool sum_done = false;
+	sum_values( chan, value_count, loop, sum, sum_done );
+	auto writer = daw::process::fork_process( [&] {
+		for( int n = 0; n < value_count; ++n ) {
+			chan.write( n );
+		}
+	} );
+	loop.run_until( [&] { return sum_done; } );
+	writer.join( );
+	daw::expecting( sum, int64_t{value_count} * ( value_count - 1 ) / 2 );
+
+	int value = 0;
+	auto values = std::vector<double>( );
+	bool tasks_done = false;
+	run_tasks( loop, value, values, tasks_done );
+	loop.run_until( [&] { return tasks_done; } );
+	daw::expecting( value, 42 );
+	daw::expecting( std::accumulate( values.begin( ), values.end( ), 0.0 ),
+	                1500.0 );
+	std::cout << "coroutines: ok" << std::endl;
+}
+#else
+int main( ) {
+	std::cout << "coroutines: not supported by this compiler" << std::endl;
+}
+#endif
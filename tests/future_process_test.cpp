@@ -20,8 +20,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <iostream>
 #include <numeric>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
 #include <unistd.h>
 
 #include <daw/daw_benchmark.h>
@@ -82,4 +86,33 @@ int main( ) {
 	auto r5 = f5.get( );
 	daw::expecting( r5.index( ) == 1 );
 	std::cout << std::get<1>( r5 ) << '\n';
+
+	auto f6 = daw::process::async(
+	  []( size_t count ) {
+		  auto result = std::vector<double>( count );
+		  std::iota( result.begin( ), result.end( ), 0.0 );
+		  return result;
+	  },
+	  1'000'000 );
+	auto const r6 = f6.get( );
+	daw::expecting( r6.size( ), 1'000'000U );
+	daw::expecting( r6.back( ), 999'999.0 );
+
+	auto f7 = daw::process::async( []( ) {
+		return std::string( "Hello from the child process" );
+	} );
+	daw::expecting( f7.get( ), std::string( "Hello from the child process" ) );
+
+	auto f8 = daw::process::async_view(
+	  []( ) { return std::vector<int>( 100'000, 42 ); } );
+	auto const r8 = f8.get( );
+	daw::expecting( r8.size( ), 100'000U );
+	daw::expecting( std::accumulate( r8.begin( ), r8.end( ), 0 ), 4'200'000 );
+
+	// Relative to the parent's nice, which may not be 0
+	auto opts = daw::process::launch_options{};
+	opts.nice = std::min( getpriority( PRIO_PROCESS, 0 ) + 3, 19 );
+	auto f9 = daw::process::async(
+	  opts, []( ) { return getpriority( PRIO_PROCESS, 0 ); } );
+	daw::expecting( f9.get( ), opts.nice );
 }
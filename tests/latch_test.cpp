@@ -0,0 +1,62 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_latch.h"
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+
+int main( ) {
+	static constexpr int worker_count = 8;
+	auto ready = daw::process::latch( worker_count );
+	auto start = daw::process::latch( 1 );
+	auto started = daw::process::shared_memory<std::atomic<int64_t>>( );
+
+	auto workers = std::vector<daw::process::fork_process<>>( );
+	for( int n = 0; n < worker_count; ++n ) {
+		workers.emplace_back( [&] {
+			ready.count_down( );
+			start.wait( );
+			started.data( )->fetch_add( 1 );
+		} );
+	}
+	puts( "parent: waiting for workers\n" );
+	ready.wait( );
+	daw::expecting( ready.try_wait( ) );
+	daw::expecting( !start.try_wait( ) );
+	daw::expecting( started.data( )->load( ), int64_t{0} );
+	start.count_down( );
+	workers.clear( );
+	daw::expecting( started.data( )->load( ), int64_t{worker_count} );
+	puts( "parent: all workers started\n" );
+
+	auto both = daw::process::latch( 2 );
+	auto proc = daw::process::fork_process( [&] { both.arrive_and_wait( ); } );
+	both.arrive_and_wait( );
+	daw::expecting( both.try_wait( ) );
+}
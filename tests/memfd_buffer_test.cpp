@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_memfd_buffer.h"
+#include "daw/daw_process.h"
+
+int main( ) {
+	auto buff = daw::process::memfd_buffer( );
+	daw::expecting( buff.size( ), 0U );
+
+	auto proc = daw::process::fork_process( [&]( ) {
+		puts( "child: appending\n" );
+		for( int n = 0; n < 1000; ++n ) {
+			auto const chunk = std::vector<int>( 1000, n );
+			buff.append( chunk.data( ), chunk.size( ) );
+		}
+	} );
+	proc.join( );
+	puts( "parent: child done\n" );
+
+	daw::expecting( buff.size( ), 1000U * 1000U * sizeof( int ) );
+	auto const v = buff.view<int>( );
+	daw::expecting( v.size( ), 1000U * 1000U );
+	for( size_t n = 0; n < 1000; ++n ) {
+		daw::expecting( v[n * 1000U], static_cast<int>( n ) );
+	}
+
+	static constexpr char const message[] = "Hello World";
+	buff.assign( message, sizeof( message ) - 1 );
+	daw::expecting( buff.read<std::string>( ), std::string( message ) );
+}
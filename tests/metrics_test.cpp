@@ -0,0 +1,167 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <shared_mutex>
+#include <thread>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_channel.h"
+#include "daw/daw_metrics.h"
+#include "daw/daw_process.h"
+#include "daw/daw_semaphore.h"
+#include "daw/daw_shared_memory.h"
+#include "daw/daw_shared_mutex.h"
+#include "daw/daw_shared_rw_mutex.h"
+
+// Without metrics nothing is added to the channel
+static_assert( sizeof( daw::process::channel<int> ) ==
+               2 * sizeof( daw::process::semaphore ) +
+                 sizeof( daw::process::shared_memory<int> ) );
+
+using histogram_t =
+  std::array<uint64_t, daw::process::metrics_histogram_size>;
+
+static uint64_t sum( histogram_t const &a ) {
+	return std::accumulate( a.begin( ), a.end( ), uint64_t{0} );
+}
+
+static void channel_metrics_test( ) {
+	static constexpr int count = 100;
+	auto chan = daw::process::channel<int64_t, daw::process::shared_metrics>( );
+	auto proc = daw::process::fork_process( [&] {
+		// Make the reader wait for the first value
+		std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+		for( int n = 0; n < count; ++n ) {
+			chan.write( n );
+		}
+	} );
+	for( int n = 0; n < count; ++n ) {
+		daw::expecting( chan.read( ), int64_t{n} );
+	}
+	proc.join( );
+
+	// Taken from another process, the counters are in shared memory
+	auto seen = daw::process::shared_memory<daw::process::metrics_snapshot>( );
+	auto reader = daw::process::fork_process(
+	  [&] { seen.write( chan.metrics( ) ); } );
+	reader.join( );
+
+	auto const m = chan.metrics( );
+	daw::expecting( m.messages, uint64_t{count} );
+	daw::expecting( m.bytes, uint64_t{count * sizeof( int64_t )} );
+	daw::expecting( m.read.acquisitions, uint64_t{count} );
+	daw::expecting( m.write.acquisitions, uint64_t{count} );
+	daw::expecting( m.read.blocked_waits >= 1 );
+	daw::expecting( m.read.wait_ns >= 10'000'000U );
+	daw::expecting( sum( m.read.wait_histogram ), m.read.blocked_waits );
+	daw::expecting( seen.read( ).messages, m.messages );
+	daw::expecting( seen.read( ).read.wait_ns, m.read.wait_ns );
+}
+
+// A writer that blocks on a full channel is only counted on the write side
+static void blocked_writer_metrics_test( ) {
+	auto chan = daw::process::channel<int, daw::process::shared_metrics>( );
+	chan.write( 1 );
+	auto proc = daw::process::fork_process( [&] {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+		daw::expecting( chan.read( ), 1 );
+	} );
+	chan.write( 2 );
+	proc.join( );
+	daw::expecting( chan.read( ), 2 );
+
+	auto const m = chan.metrics( );
+	daw::expecting( m.write.acquisitions, uint64_t{2} );
+	daw::expecting( m.write.blocked_waits, uint64_t{1} );
+	daw::expecting( m.write.wait_ns >= 10'000'000U );
+	daw::expecting( sum( m.write.wait_histogram ), uint64_t{1} );
+	daw::expecting( m.read.acquisitions, uint64_t{2} );
+	daw::expecting( m.read.blocked_waits, uint64_t{0} );
+	daw::expecting( m.read.wait_ns, uint64_t{0} );
+	daw::expecting( sum( m.read.wait_histogram ), uint64_t{0} );
+}
+
+static void mutex_metrics_test( ) {
+	auto mtx = daw::process::basic_shared_mutex<daw::process::shared_metrics>( );
+	auto locked = daw::process::semaphore( );
+	auto proc = daw::process::fork_process( [&] {
+		auto lck = std::lock_guard( mtx );
+		locked.post( );
+		std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+	} );
+	locked.wait( );
+	{
+		auto lck = std::lock_guard( mtx );
+	}
+	proc.join( );
+	auto const m = mtx.metrics( );
+	daw::expecting( m.write.acquisitions, uint64_t{2} );
+	daw::expecting( m.write.blocked_waits, uint64_t{1} );
+	daw::expecting( m.read.acquisitions, uint64_t{0} );
+	daw::expecting( m.hold_ns >= 10'000'000U );
+	daw::expecting( sum( m.hold_histogram ), uint64_t{2} );
+	daw::expecting( m.messages, uint64_t{0} );
+}
+
+// Shared holds go to the read side and are not timed
+static void rw_mutex_metrics_test( ) {
+	auto mtx =
+	  daw::process::basic_shared_rw_mutex<daw::process::shared_metrics>( );
+	auto const readers = [&] {
+		for( int n = 0; n < 1000; ++n ) {
+			auto lck = std::shared_lock( mtx );
+		}
+	};
+	auto proc = daw::process::fork_process( readers );
+	auto thr = std::thread( readers );
+	readers( );
+	thr.join( );
+	proc.join( );
+	{
+		auto lck = std::lock_guard( mtx );
+	}
+	auto const m = mtx.metrics( );
+	daw::expecting( m.read.acquisitions, uint64_t{3000} );
+	daw::expecting( m.write.acquisitions, uint64_t{1} );
+	daw::expecting( sum( m.hold_histogram ), uint64_t{1} );
+}
+
+int main( ) {
+	channel_metrics_test( );
+	blocked_writer_metrics_test( );
+	mutex_metrics_test( );
+	rw_mutex_metrics_test( );
+
+	// The default policy reports nothing
+	auto chan = daw::process::channel<int>( );
+	chan.write( 1 );
+	daw::expecting( chan.read( ), 1 );
+	daw::expecting( chan.metrics( ).messages, uint64_t{0} );
+	std::cout << "metrics: ok" << std::endl;
+}
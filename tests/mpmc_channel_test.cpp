@@ -0,0 +1,76 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_channel.h"
+#include "daw/daw_mpmc_channel.h"
+#include "daw/daw_process.h"
+
+int main( ) {
+	static constexpr uint64_t producer_count = 4;
+	static constexpr uint64_t consumer_count = 3;
+	static constexpr uint64_t count = 50'000;
+	// Tells a consumer that there is no more data
+	static constexpr uint64_t done = 0;
+
+	auto chan = daw::process::mpmc_channel<uint64_t, 32>( );
+	auto results = daw::process::channel<uint64_t>( );
+
+	std::vector<daw::process::fork_process<>> consumers{};
+	for( size_t n = 0; n < consumer_count; ++n ) {
+		consumers.emplace_back( [&]( ) {
+			uint64_t sum = 0;
+			for( auto v = chan.read( ); v != done; v = chan.read( ) ) {
+				sum += v;
+			}
+			results.write( sum );
+		} );
+	}
+	std::vector<daw::process::fork_process<>> producers{};
+	for( uint64_t n = 0; n < producer_count; ++n ) {
+		producers.emplace_back( [&]( uint64_t first ) {
+			for( uint64_t v = first; v < first + count; ++v ) {
+				chan.write( v );
+			}
+		}, n * count + 1 );
+	}
+	puts( "parent: waiting on producers\n" );
+	for( auto &p : producers ) {
+		p.join( );
+	}
+	for( size_t n = 0; n < consumer_count; ++n ) {
+		chan.write( done );
+	}
+	uint64_t sum = 0;
+	for( size_t n = 0; n < consumer_count; ++n ) {
+		sum += results.read( );
+	}
+	static constexpr uint64_t total = producer_count * count;
+	daw::expecting( sum, ( total * ( total + 1 ) ) / 2 );
+	daw::expecting( !chan.try_read( ) );
+	puts( "parent: consumers saw every value once\n" );
+}
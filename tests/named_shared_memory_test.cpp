@@ -0,0 +1,143 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_channel.h"
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+#include "daw/daw_shared_mutex.h"
+
+namespace {
+	constexpr int value_count = 100;
+
+	struct counters_t {
+		int64_t sum;
+		int64_t writes;
+	};
+
+	// Runs after exec, so nothing but the names and the fd is shared with the
+	// parent
+	int run_child( std::string const &name, int fd ) {
+		auto chan = daw::process::channel<int>( daw::process::open_or_create,
+		                                        name + ".chan" );
+		auto mtx = daw::process::shared_mutex( daw::process::open_or_create,
+		                                       name + ".mutex" );
+		auto counters = daw::process::shared_memory<counters_t>(
+		  daw::process::from_handle, fd );
+		for( int n = 0; n < value_count; ++n ) {
+			{
+				auto lck = std::lock_guard( mtx );
+				counters.data( )->sum += n;
+				++counters.data( )->writes;
+			}
+			chan.write( n );
+		}
+		return EXIT_SUCCESS;
+	}
+} // namespace
+
+int main( int argc, char **argv ) {
+	if( argc == 4 and std::string( argv[1] ) == "child" ) {
+		return run_child( argv[2], std::stoi( argv[3] ) );
+	}
+	auto const name = "/daw_named_test_" + std::to_string( getpid( ) );
+	auto chan =
+	  daw::process::channel<int>( daw::process::open_or_create, name + ".chan" );
+	auto mtx = daw::process::shared_mutex( daw::process::open_or_create,
+	                                       name + ".mutex" );
+	auto counters =
+	  daw::process::shared_memory<counters_t>( daw::process::inheritable );
+	auto const fd = std::to_string( counters.native_handle( ) );
+
+	auto child = daw::process::fork_process( [&]( ) {
+		char child_arg[] = "child";
+		char *args[] = {argv[0], child_arg, const_cast<char *>( name.c_str( ) ),
+		                const_cast<char *>( fd.c_str( ) ), nullptr};
+		execv( "/proc/self/exe", args );
+		std::cerr << "exec failed\n";
+		_exit( EXIT_FAILURE );
+	} );
+
+	int64_t sum = 0;
+	for( int n = 0; n < value_count; ++n ) {
+		auto const value = chan.read( );
+		daw::expecting( value, n );
+		sum += value;
+	}
+	child.join( );
+	{
+		auto lck = std::lock_guard( mtx );
+		daw::expecting( counters.data( )->sum, sum );
+		daw::expecting( counters.data( )->writes, int64_t{value_count} );
+	}
+	daw::expecting( daw::process::channel<int>::remove( name + ".chan" ) );
+	daw::expecting(
+	  daw::process::shared_mutex::remove( name + ".mutex" ) );
+	// The names are gone, attaching again starts fresh
+	auto again = daw::process::shared_memory<counters_t>(
+	  daw::process::open_or_create, name + ".fresh" );
+	daw::expecting( again.data( )->writes, int64_t{0} );
+	daw::expecting(
+	  daw::process::shared_memory<counters_t>::remove( name + ".fresh" ) );
+
+	// A creator that dies while setting up leaves an object others refuse to
+	// attach to, until it is removed
+	auto creator = daw::process::fork_process( [&] {
+		auto dead = daw::process::shared_memory<counters_t>(
+		  daw::process::open_or_create, name + ".dead",
+		  []( counters_t & ) { _exit( EXIT_FAILURE ); } );
+	} );
+	creator.join( );
+	bool has_thrown = false;
+	try {
+		auto dead = daw::process::shared_memory<counters_t>(
+		  daw::process::open_or_create, name + ".dead" );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+	daw::expecting(
+	  daw::process::shared_memory<counters_t>::remove( name + ".dead" ) );
+
+	// When on_create throws the name is removed again
+	has_thrown = false;
+	try {
+		auto failed = daw::process::shared_memory<counters_t>(
+		  daw::process::open_or_create, name + ".failed",
+		  []( counters_t & ) { throw std::runtime_error( "on_create" ); } );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+	auto retried = daw::process::shared_memory<counters_t>(
+	  daw::process::open_or_create, name + ".failed",
+	  []( counters_t &c ) { c.writes = 1; } );
+	daw::expecting( retried.data( )->writes, int64_t{1} );
+	daw::expecting(
+	  daw::process::shared_memory<counters_t>::remove( name + ".failed" ) );
+	std::cout << "named shared memory: ok\n";
+}
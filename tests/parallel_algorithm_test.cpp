@@ -0,0 +1,142 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_parallel_algorithm.h"
+#include "daw/daw_process_pool.h"
+#include "daw/daw_shared_memory.h"
+
+namespace {
+	constexpr size_t count = 100'000;
+	constexpr size_t worker_count = 4;
+
+	int64_t square( int64_t v ) {
+		return v * v;
+	}
+
+	int64_t expected_sum_of_squares( std::vector<int64_t> const &values ) {
+		return std::accumulate(
+		  values.begin( ), values.end( ), int64_t{0},
+		  []( int64_t a, int64_t v ) { return a + square( v ); } );
+	}
+} // namespace
+
+int main( ) {
+	auto values = std::vector<int64_t>( count );
+	std::iota( values.begin( ), values.end( ), int64_t{-5'000} );
+	auto const expected = expected_sum_of_squares( values );
+
+	auto const sum = daw::process::transform_reduce(
+	  values.begin( ), values.end( ), int64_t{0}, std::plus<>{}, square,
+	  worker_count );
+	daw::expecting( sum, expected );
+
+	auto squares = std::vector<int64_t>( count );
+	auto const last = daw::process::transform(
+	  values.begin( ), values.end( ), squares.begin( ), square, worker_count );
+	daw::expecting( last == squares.end( ) );
+	for( size_t n = 0; n < count; ++n ) {
+		daw::expecting( squares[n], square( values[n] ) );
+	}
+
+	// Side effects are only visible through shared memory
+	auto seen = daw::process::shared_memory<int64_t[]>( count );
+	daw::process::parallel_for(
+	  values.begin( ), values.end( ),
+	  [&]( int64_t const &v ) {
+		  seen[static_cast<size_t>( &v - values.data( ) )] = v;
+	  },
+	  worker_count );
+	daw::expecting( std::equal( values.begin( ), values.end( ), seen.begin( ) ) );
+
+	// More workers than values and no values
+	daw::expecting( daw::process::transform_reduce(
+	                  values.begin( ), values.begin( ) + 2, int64_t{1},
+	                  std::plus<>{}, square, 16 ),
+	                int64_t{1} + square( values[0] ) + square( values[1] ) );
+	daw::expecting( daw::process::transform_reduce(
+	                  values.begin( ), values.begin( ), int64_t{7},
+	                  std::plus<>{}, square ),
+	                int64_t{7} );
+
+	bool has_thrown = false;
+	try {
+		daw::process::parallel_for(
+		  values.begin( ), values.end( ),
+		  []( int64_t v ) {
+			  if( v == 0 ) {
+				  _Exit( EXIT_FAILURE );
+			  }
+		  },
+		  worker_count );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+
+	// An exception in a worker ends that worker instead of unwinding into this
+	// code in the child, only the caller sees the error
+	auto const caller = ::getpid( );
+	auto catches = daw::process::shared_memory<int>( );
+	has_thrown = false;
+	try {
+		daw::process::parallel_for(
+		  values.begin( ), values.end( ),
+		  []( int64_t v ) {
+			  if( v == 0 ) {
+				  throw std::logic_error( "worker failure" );
+			  }
+		  },
+		  worker_count );
+	} catch( std::runtime_error const & ) {
+		has_thrown = ::getpid( ) == caller;
+		catches.write( catches.read( ) + 1 );
+	}
+	daw::expecting( has_thrown );
+	daw::expecting( catches.read( ), 1 );
+
+	// The pool is created after the input and output exist so its workers see
+	// them
+	auto pooled_out = daw::process::shared_memory<int64_t[]>( count );
+	auto pool = daw::process::process_pool( worker_count );
+	auto const pooled_sum = daw::process::transform_reduce(
+	  pool, values.data( ), values.data( ) + count, int64_t{0}, std::plus<>{},
+	  square );
+	daw::expecting( pooled_sum, expected );
+	daw::process::transform( pool, values.data( ), values.data( ) + count,
+	                         pooled_out.data( ), square );
+	daw::expecting(
+	  std::equal( squares.begin( ), squares.end( ), pooled_out.begin( ) ) );
+	daw::process::parallel_for( pool, values.data( ), values.data( ) + count,
+	                            []( int64_t const & ) {} );
+	std::cout << "parallel algorithms: ok" << std::endl;
+}
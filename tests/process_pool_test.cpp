@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process_pool.h"
+
+struct A {
+	double a = 0.0;
+	unsigned long long c = 0;
+};
+
+int main( ) {
+	auto pool = daw::process::process_pool( 4 );
+	daw::expecting( pool.size( ), 4U );
+
+	std::vector<std::future<int>> futs{};
+	for( int n = 0; n < 1000; ++n ) {
+		futs.push_back( pool.async( []( int b ) { return b * b; }, n ) );
+	}
+	auto const sums =
+	  std::accumulate( futs.begin( ), futs.end( ), 0,
+	                   []( int s, auto &f ) { return s + f.get( ); } );
+	daw::expecting( sums, 332'833'500 );
+
+	auto f2 = pool.async(
+	  []( int arg ) {
+		  return A{arg * 1.5, static_cast<unsigned long long>( arg ) * 100ULL};
+	  },
+	  2 );
+	auto const r2 = f2.get( );
+	daw::expecting( r2.a == 3.0 and r2.c == 200ULL );
+
+	auto f3 = pool.async( []( ) -> int { throw std::exception( ); } );
+	bool has_thrown = false;
+	try {
+		(void)f3.get( );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+
+	auto f4 = pool.async( []( ) { puts( "worker: void task\n" ); } );
+	f4.get( );
+
+	// A worker that dies fails the future of its task, the others carry on
+	auto f5 = pool.async( []( ) -> int { _exit( EXIT_FAILURE ); } );
+	has_thrown = false;
+	try {
+		(void)f5.get( );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+	daw::expecting( pool.async( []( int b ) { return b + 1; }, 41 ).get( ), 42 );
+
+	// Once every worker is gone nothing can run
+	auto lone_pool = daw::process::process_pool( 1 );
+	auto f6 = lone_pool.async( []( ) { raise( SIGKILL ); } );
+	has_thrown = false;
+	try {
+		f6.get( );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+	has_thrown = false;
+	try {
+		(void)lone_pool.async( []( ) { return 1; } );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+}
@@ -0,0 +1,60 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process.h"
+#include "daw/daw_process_reaper.h"
+
+int main( ) {
+	static constexpr int child_count = 200;
+	std::vector<std::future<int>> statuses{};
+	for( int n = 0; n < child_count; ++n ) {
+		auto proc = daw::process::fork_process<false>(
+		  []( int code ) {
+			  usleep( 1000 );
+			  exit( code );
+		  },
+		  n % 100 );
+		auto status = std::promise<int>( );
+		statuses.push_back( status.get_future( ) );
+		daw::process::process_reaper::get( ).watch(
+		  proc.native_handle( ),
+		  [status = std::move( status )]( int s ) mutable {
+			  status.set_value( s );
+		  } );
+	}
+	puts( "parent: waiting on children\n" );
+	for( int n = 0; n < child_count; ++n ) {
+		auto const status = statuses[static_cast<size_t>( n )].get( );
+		daw::expecting( WIFEXITED( status ) );
+		daw::expecting( WEXITSTATUS( status ), n % 100 );
+	}
+	puts( "parent: all children reaped\n" );
+}
@@ -20,11 +20,16 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <cassert>
+#include <algorithm>
+#include <csignal>
 #include <cstdio>
 #include <numeric>
+#include <sched.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
+#include <daw/daw_benchmark.h>
+
 #include "daw/daw_process.h"
 #include "daw/daw_semaphore.h"
 
@@ -40,7 +45,7 @@ int main( ) {
 
 	puts( "Waiting on child\n" );
 	proc.join( );
-	assert( sem.try_wait( ) );
+	daw::expecting( sem.try_wait( ) );
 	puts( "Child complete\n" );
 
 	proc = daw::process::fork_process(
@@ -52,6 +57,67 @@ int main( ) {
 
 	puts( "Waiting on child\n" );
 	proc.join( );
-	assert( !sem.try_wait( ) );
+	daw::expecting( !sem.try_wait( ) );
 	puts( "Child successfully errored\n" );
+
+	// The child shares the parent's memory and the parent waits for it to exit
+	int value = 0;
+	auto vproc = daw::process::fork_process<true, daw::process::vfork_spawn>(
+	  [&value]( int v ) { value = v; }, 42 );
+	vproc.join( );
+	daw::expecting( value, 42 );
+
+	// Or to exec
+	vproc = daw::process::fork_process<true, daw::process::vfork_spawn>( [] {
+		execl( "/bin/sh", "sh", "-c", "exit 0", static_cast<char *>( nullptr ) );
+	} );
+	daw::expecting( vproc.joinable( ) );
+	vproc.join( );
+
+	// The parent's signal handlers are reset in the child but not in the parent
+	struct sigaction handler {};
+	handler.sa_handler = +[]( int ) {};
+	sigaction( SIGUSR1, &handler, nullptr );
+	bool is_reset = false;
+	vproc = daw::process::fork_process<true, daw::process::vfork_spawn>(
+	  [&is_reset] {
+		  struct sigaction action {};
+		  sigaction( SIGUSR1, nullptr, &action );
+		  is_reset = action.sa_handler == SIG_DFL;
+	  } );
+	vproc.join( );
+	daw::expecting( is_reset );
+	sigaction( SIGUSR1, nullptr, &handler );
+	daw::expecting( handler.sa_handler != SIG_DFL );
+	signal( SIGUSR1, SIG_DFL );
+	puts( "vfork_spawn children complete\n" );
+
+	// Launch options are applied in the child before the callable
+	// Relative to the parent's so that this runs under any affinity or nice
+	cpu_set_t allowed;
+	CPU_ZERO( &allowed );
+	sched_getaffinity( 0, sizeof( allowed ), &allowed );
+	int cpu = 0;
+	while( !CPU_ISSET( cpu, &allowed ) ) {
+		++cpu;
+	}
+	auto const parent_nice = getpriority( PRIO_PROCESS, 0 );
+	auto opts = daw::process::launch_options{};
+	opts.cpus = {cpu};
+	opts.sched_policy = SCHED_BATCH;
+	opts.nice = std::min( parent_nice + 5, 19 );
+	proc = daw::process::fork_process( opts, [&sem, cpu, nice = opts.nice] {
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		sched_getaffinity( 0, sizeof( set ), &set );
+		if( CPU_COUNT( &set ) == 1 and CPU_ISSET( cpu, &set ) and
+		    sched_getscheduler( 0 ) == SCHED_BATCH and
+		    getpriority( PRIO_PROCESS, 0 ) == nice ) {
+			sem.post( );
+		}
+	} );
+	proc.join( );
+	daw::expecting( sem.try_wait( ) );
+	daw::expecting( getpriority( PRIO_PROCESS, 0 ), parent_nice );
+	puts( "Launch options applied\n" );
 }
@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <unistd.h>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process.h"
+#include "daw/daw_ring_channel.h"
+
+int main( ) {
+	auto chan = daw::process::ring_channel<size_t, 16>( );
+	static constexpr size_t count = 100'000;
+
+	auto proc = daw::process::fork_process( [&]( ) {
+		puts( "child: sending\n" );
+		for( size_t n = 0; n < count; ++n ) {
+			chan.write( n );
+		}
+		puts( "child: sent\n" );
+	} );
+
+	puts( "parent: awaiting child\n" );
+	for( size_t n = 0; n < count; ++n ) {
+		daw::expecting( chan.read( ), n );
+	}
+	daw::expecting( !chan.try_read( ) );
+	puts( "parent: got all of child's messages\n" );
+
+	for( size_t n = 0; n < chan.capacity( ); ++n ) {
+		daw::expecting( chan.try_write( n ) );
+	}
+	daw::expecting( !chan.try_write( 0 ) );
+	for( size_t n = 0; n < chan.capacity( ); ++n ) {
+		daw::expecting( chan.try_read( ).value( ), n );
+	}
+}
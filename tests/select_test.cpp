@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <poll.h>
+#include <stdexcept>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_channel.h"
+#include "daw/daw_mpmc_channel.h"
+#include "daw/daw_pollable.h"
+#include "daw/daw_process.h"
+#include "daw/daw_ring_channel.h"
+
+int main( ) {
+	using namespace std::chrono_literals;
+	using daw::process::no_metrics;
+	using daw::process::pollable;
+	auto a = daw::process::channel<int, no_metrics, pollable>( );
+	auto b = daw::process::ring_channel<int, 16, no_metrics, pollable>( );
+	auto c = daw::process::mpmc_channel<int, 16, no_metrics, pollable>( );
+	static constexpr int count = 1'000;
+
+	daw::expecting( !daw::process::select_for( 10ms, a, b, c ) );
+
+	// The handles are plain fds and work with poll directly
+	c.write( 1 );
+	auto pfd = pollfd{c.poll_handle( ), POLLIN, 0};
+	daw::expecting( poll( &pfd, 1, 0 ), 1 );
+	daw::expecting( daw::process::select( a, b, c ), size_t{2} );
+	daw::expecting( c.read( ), 1 );
+	// A huge timeout must not overflow the deadline
+	b.write( 2 );
+	auto const forever = std::chrono::hours::max( );
+	daw::expecting( daw::process::select_for( forever, a, b, c ),
+	                std::optional<size_t>( 1 ) );
+	daw::expecting( b.read( ), 2 );
+
+	auto proc = daw::process::fork_process( [&]( ) {
+		puts( "child: sending\n" );
+		for( int n = 0; n < count; ++n ) {
+			switch( n % 3 ) {
+			case 0:
+				a.write( n );
+				break;
+			case 1:
+				b.write( n );
+				break;
+			default:
+				c.write( n );
+				break;
+			}
+		}
+		puts( "child: sent\n" );
+	} );
+
+	puts( "parent: selecting\n" );
+	auto next = std::array<int, 3>{0, 1, 2};
+	for( int n = 0; n < count; ++n ) {
+		auto const index = daw::process::select( a, b, c );
+		auto const value = index == 0 ? a.read( )
+		                   : index == 1 ? b.read( )
+		                                : c.read( );
+		daw::expecting( value, next[index] );
+		next[index] += 3;
+	}
+	daw::expecting( !daw::process::select_for( 0ms, a, b, c ) );
+	puts( "parent: got all of child's messages\n" );
+
+	auto plain = daw::process::channel<int>( );
+	daw::expecting( plain.poll_handle( ), -1 );
+	try {
+		(void)daw::process::select( a, plain );
+		daw::expecting( false );
+	} catch( std::invalid_argument const & ) {}
+}
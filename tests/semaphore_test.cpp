@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <unistd.h>
 
+#include <daw/daw_benchmark.h>
 #include <daw/daw_process.h>
 #include <daw/daw_semaphore.h>
 
@@ -52,4 +53,12 @@ int main( ) {
 		sem_a.post( );
 		puts( "parent: sent child's post\n" );
 	}
+
+	auto sem_c = daw::process::semaphore( 2 );
+	daw::expecting( sem_c.try_wait( ) );
+	daw::expecting( sem_c.try_wait( ) );
+	daw::expecting( !sem_c.try_wait( ) );
+	sem_c.post( );
+	sem_c.wait( );
+	daw::expecting( !sem_c.try_wait( ) );
 }
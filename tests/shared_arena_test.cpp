@@ -0,0 +1,83 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <memory_resource>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process.h"
+#include "daw/daw_shared_arena.h"
+
+struct node_t {
+	int value = 0;
+	daw::process::offset_ptr<node_t> next{};
+};
+
+int main( ) {
+	auto arena = daw::process::shared_arena( 64U * 1024U * 1024U );
+
+	auto *vec = arena.make<std::pmr::vector<int>>( &arena );
+	vec->resize( 1000 );
+	std::iota( vec->begin( ), vec->end( ), 0 );
+	daw::expecting( arena.contains( vec->data( ) ) );
+
+	auto *head = arena.make<node_t>( );
+	auto proc = daw::process::fork_process( [&]( ) {
+		puts( "child: appending\n" );
+		// Both growing the vector and the new nodes allocate after the fork
+		for( int n = 1000; n < 100'000; ++n ) {
+			vec->push_back( n );
+		}
+		auto *last = head;
+		for( int n = 1; n <= 10; ++n ) {
+			last->next = arena.make<node_t>( node_t{n, nullptr} );
+			last = last->next.get( );
+		}
+	} );
+	proc.join( );
+	puts( "parent: child done\n" );
+
+	daw::expecting( vec->size( ), 100'000U );
+	for( size_t n = 0; n < vec->size( ); ++n ) {
+		daw::expecting( ( *vec )[n], static_cast<int>( n ) );
+	}
+	int sum = 0;
+	for( auto *node = head; node; node = node->next.get( ) ) {
+		sum += node->value;
+	}
+	daw::expecting( sum, 55 );
+
+	// Freed blocks are reused for the same size class
+	auto *p1 = arena.allocate( 40 );
+	arena.deallocate( p1, 40 );
+	auto *p2 = arena.allocate( 64 );
+	daw::expecting( p1 == p2 );
+	arena.deallocate( p2, 64 );
+
+	auto str =
+	  std::pmr::string( "a string too long for the small buffer", &arena );
+	daw::expecting( arena.contains( str.data( ) ) );
+}
@@ -0,0 +1,86 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <cstdio>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+
+int main( ) {
+	static constexpr size_t count = 4'000'000;
+	static constexpr size_t worker_count = 4;
+	auto arr = daw::process::shared_memory<double[]>( count );
+	daw::expecting( arr.size( ), count );
+
+	std::vector<daw::process::fork_process<>> workers{};
+	for( size_t w = 0; w < worker_count; ++w ) {
+		workers.emplace_back(
+		  [&]( size_t first ) {
+			  // Each worker fills its own part of the array in place
+			  auto part = arr.subspan( first, count / worker_count );
+			  for( size_t n = 0; n < part.size( ); ++n ) {
+				  part[n] = static_cast<double>( first + n );
+			  }
+		  },
+		  w * ( count / worker_count ) );
+	}
+	workers.clear( );
+	puts( "parent: workers done\n" );
+	for( size_t n = 0; n < count; ++n ) {
+		daw::expecting( arr[n], static_cast<double>( n ) );
+	}
+
+	arr.resize( count * 2 );
+	daw::expecting( arr.size( ), count * 2 );
+	daw::expecting( arr[count - 1], static_cast<double>( count - 1 ) );
+	daw::expecting( arr[count * 2 - 1], 0.0 );
+
+	auto proc = daw::process::fork_process( [&]( ) {
+		arr.resize( count * 3 );
+		arr[count * 3 - 1] = 9.0;
+	} );
+	proc.join( );
+	arr.refresh( );
+	daw::expecting( arr.size( ), count * 3 );
+	daw::expecting( arr[count * 3 - 1], 9.0 );
+
+	// Shrinking would pull pages from under the other processes
+	bool has_thrown = false;
+	try {
+		arr.resize( 10 );
+	} catch( std::invalid_argument const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+	daw::expecting( arr.size( ), count * 3 );
+
+	// A copy with a stale size grows it without undoing a larger growth
+	auto stale = daw::process::shared_memory<double[]>( arr );
+	arr.resize( count * 4 );
+	stale.resize( count * 3 + 1 );
+	arr.refresh( );
+	daw::expecting( arr.size( ), count * 4 );
+}
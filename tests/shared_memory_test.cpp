@@ -0,0 +1,54 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <cstdio>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+
+using daw::process::huge_pages;
+using daw::process::shared_memory_options;
+
+static void round_trip( shared_memory_options const &opts ) {
+	auto mem = daw::process::shared_memory<std::array<int, 4096>>( opts );
+	auto proc = daw::process::fork_process( [&]( ) {
+		auto value = std::array<int, 4096>{};
+		value.back( ) = 42;
+		mem.write( value );
+	} );
+	proc.join( );
+	daw::expecting( mem.read( ).back( ), 42 );
+}
+
+int main( ) {
+	round_trip( shared_memory_options{} );
+	round_trip( shared_memory_options{true} );
+	round_trip( shared_memory_options{false, huge_pages::transparent} );
+	// Falls back to regular pages when there are no huge pages reserved
+	round_trip( shared_memory_options{true, huge_pages::hugetlb} );
+	round_trip( shared_memory_options{true, huge_pages::none, true} );
+	round_trip( shared_memory_options{true, huge_pages::none, false, 0} );
+	puts( "all options mapped\n" );
+}
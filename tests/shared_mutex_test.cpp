@@ -24,10 +24,49 @@
 #include <mutex>
 #include <unistd.h>
 
+#include <daw/daw_benchmark.h>
+
 #include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
 #include "daw/daw_shared_mutex.h"
 
+void owner_death_test( ) {
+	auto mtx = daw::process::shared_mutex( );
+	auto held = daw::process::shared_memory<bool>( );
+	// The child exits while still holding the lock
+	auto proc = daw::process::fork_process( [&]( ) {
+		mtx.lock( );
+		held.write( true );
+	} );
+	proc.join( );
+	daw::expecting( held.read( ) );
+
+	auto lck = std::unique_lock( mtx );
+	daw::expecting( mtx.owner_died( ) );
+	mtx.consistent( );
+	daw::expecting( !mtx.owner_died( ) );
+	lck.unlock( );
+
+	// Still usable after recovery
+	daw::expecting( mtx.try_lock( ) );
+	daw::expecting( !mtx.owner_died( ) );
+	mtx.unlock( );
+}
+
+void try_lock_test( ) {
+	auto mtx = daw::process::shared_mutex( );
+	auto lck = std::unique_lock( mtx );
+	auto result = daw::process::shared_memory<bool>( );
+	auto proc =
+	  daw::process::fork_process( [&]( ) { result.write( mtx.try_lock( ) ); } );
+	proc.join( );
+	daw::expecting( !result.read( ) );
+}
+
 int main( ) {
+	owner_death_test( );
+	try_lock_test( );
+
 	auto mut = daw::process::shared_mutex( );
 	auto lck = std::unique_lock( mut );
 
@@ -0,0 +1,94 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+#include "daw/daw_shared_rw_mutex.h"
+
+struct table_t {
+	int64_t first;
+	int64_t second;
+};
+
+int main( ) {
+	auto mtx = daw::process::shared_rw_mutex( );
+	{
+		// Readers share the lock and keep writers out
+		auto lck = std::shared_lock( mtx );
+		auto results = daw::process::shared_memory<std::array<bool, 2>>( );
+		auto proc = daw::process::fork_process( [&]( ) {
+			auto const can_read = mtx.try_lock_shared( );
+			if( can_read ) {
+				mtx.unlock_shared( );
+			}
+			results.write( {can_read, mtx.try_lock( )} );
+		} );
+		proc.join( );
+		daw::expecting( results.read( )[0] );
+		daw::expecting( !results.read( )[1] );
+	}
+
+	static constexpr size_t reader_count = 4;
+	static constexpr int64_t update_count = 2'000;
+	auto table = daw::process::shared_memory<table_t>( );
+	auto errors = daw::process::shared_memory<std::atomic<int64_t>>( );
+	auto done = daw::process::shared_memory<std::atomic<bool>>( );
+
+	std::vector<daw::process::fork_process<>> readers{};
+	for( size_t n = 0; n < reader_count; ++n ) {
+		readers.emplace_back( [&]( ) {
+			while( !done.data( )->load( ) ) {
+				auto lck = std::shared_lock( mtx );
+				auto const t = table.read( );
+				if( t.first != t.second ) {
+					errors.data( )->fetch_add( 1 );
+				}
+			}
+		} );
+	}
+	auto writer = daw::process::fork_process( [&]( ) {
+		for( int64_t n = 1; n <= update_count; ++n ) {
+			auto lck = std::unique_lock( mtx );
+			table.data( )->first = n;
+			table.data( )->second = n;
+		}
+	} );
+	writer.join( );
+	done.data( )->store( true );
+	readers.clear( );
+	puts( "parent: readers done\n" );
+
+	daw::expecting( errors.data( )->load( ), int64_t{0} );
+	daw::expecting( table.read( ).first, update_count );
+	daw::expecting( mtx.try_lock( ) );
+	mtx.unlock( );
+}
@@ -0,0 +1,83 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_process.h"
+#include "daw/daw_shared_memory.h"
+#include "daw/daw_shared_seqlock.h"
+
+struct route_t {
+	int64_t version;
+	int64_t negated;
+	int64_t doubled;
+};
+
+int main( ) {
+	static constexpr size_t reader_count = 4;
+	static constexpr size_t writer_count = 2;
+	static constexpr int64_t update_count = 20'000;
+
+	auto route = daw::process::shared_seqlock<route_t>( route_t{0, 0, 0} );
+	auto errors = daw::process::shared_memory<std::atomic<int64_t>>( );
+	auto done = daw::process::shared_memory<std::atomic<bool>>( );
+
+	std::vector<daw::process::fork_process<>> readers{};
+	for( size_t n = 0; n < reader_count; ++n ) {
+		readers.emplace_back( [&]( ) {
+			while( !done.data( )->load( ) ) {
+				auto const r = route.load( );
+				if( r.negated != -r.version or r.doubled != 2 * r.version ) {
+					errors.data( )->fetch_add( 1 );
+				}
+			}
+		} );
+	}
+	std::vector<daw::process::fork_process<>> writers{};
+	for( size_t n = 0; n < writer_count; ++n ) {
+		writers.emplace_back( [&]( ) {
+			for( int64_t i = 0; i < update_count; ++i ) {
+				route.update( []( route_t &r ) {
+					++r.version;
+					r.negated = -r.version;
+					r.doubled = 2 * r.version;
+				} );
+			}
+		} );
+	}
+	writers.clear( );
+	done.data( )->store( true );
+	readers.clear( );
+	puts( "parent: readers done\n" );
+
+	daw::expecting( errors.data( )->load( ), int64_t{0} );
+	auto const r = route.load( );
+	daw::expecting( r.version,
+	                static_cast<int64_t>( writer_count ) * update_count );
+	route.store( route_t{1, -1, 2} );
+	daw::expecting( route.load( ).doubled, int64_t{2} );
+}
@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <string>
@@ -54,4 +55,21 @@ int main( ) {
 		std::cout << "parent: message from child '" << val << "'\n";
 		daw::expecting( val, message );
 	}
+
+	auto lease_chan = daw::process::string_channel<char>( message.size( ) );
+	auto proc2 = daw::process::fork_process( [&]( ) {
+		auto buff = lease_chan.acquire_write( message.size( ) );
+		std::copy( message.begin( ), message.end( ), buff.begin( ) );
+		lease_chan.commit( );
+
+		buff = lease_chan.acquire_write( message.size( ) );
+		std::copy_n( message.begin( ), 4, buff.begin( ) );
+		lease_chan.commit( 4 );
+	} );
+	auto sv = lease_chan.acquire_read( );
+	daw::expecting( sv, message );
+	lease_chan.release( );
+	sv = lease_chan.acquire_read( );
+	daw::expecting( sv, message.substr( 0, 4 ) );
+	lease_chan.release( );
 }
@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <stdexcept>
+#include <sys/prctl.h>
+#include <unistd.h>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/daw_zygote.h"
+
+static int square( int v ) {
+	return v * v;
+}
+
+static void crash( ) {
+	abort( );
+}
+
+static int is_subreaper( ) {
+	int result = 0;
+	daw::expecting( prctl( PR_GET_CHILD_SUBREAPER, &result ), 0 );
+	return result;
+}
+
+// The caller is a subreaper only while a zygote is alive
+static void subreaper_test( ) {
+	daw::expecting( is_subreaper( ), 0 );
+	{
+		auto outer = daw::process::zygote( );
+		{
+			auto inner = daw::process::zygote( );
+		}
+		daw::expecting( is_subreaper( ), 1 );
+	}
+	daw::expecting( is_subreaper( ), 0 );
+}
+
+int main( ) {
+	subreaper_test( );
+	auto zyg = daw::process::zygote( );
+
+	// Allocated after the zygote, the workers never get a copy of it
+	auto ballast = std::vector<char>( 64U * 1024U * 1024U, 1 );
+
+	puts( "parent: spawning\n" );
+	auto proc = zyg.spawn( &square, 5 );
+	daw::expecting( proc.joinable( ) );
+	proc.join( );
+
+	daw::expecting( zyg.async( &square, 7 ).get( ), 49 );
+
+	// The workers are children of this process
+	daw::expecting( zyg.async( +[] { return getppid( ); } ).get( ), getpid( ) );
+
+	// More calls than result slots
+	auto futs = std::vector<std::future<int>>( );
+	for( int n = 0; n < 200; ++n ) {
+		futs.push_back( zyg.async( &square, n ) );
+	}
+	for( int n = 0; n < 200; ++n ) {
+		daw::expecting( futs[static_cast<size_t>( n )].get( ), n * n );
+	}
+	puts( "parent: got all results\n" );
+
+	auto failed = zyg.async( +[]( ) {
+		crash( );
+		return 0;
+	} );
+	try {
+		(void)failed.get( );
+		daw::expecting( false );
+	} catch( std::runtime_error const & ) {}
+	daw::expecting( ballast.back( ), char{1} );
+}